@@ -0,0 +1,165 @@
+# -*- coding: utf-8 -*-
+
+# Python for XUL
+# copyright © 2021 Malek Hadj-Ali
+#
+# This program is free software: you can redistribute it and/or modify it
+# under the terms of the GNU General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+"""asyncio on the Gecko main thread.
+
+call_soon() dispatches a runnable to the main thread event queue and
+call_at()/call_later() arm a one shot nsITimer, nothing is polled. Gecko
+spins the events: once installed the loop is always running and
+run_forever()/run_until_complete() can't be used.
+
+    import xpcom_asyncio
+    loop = xpcom_asyncio.install()
+    loop.create_task(main())
+"""
+
+
+from xpcom import Components, Interfaces
+
+import asyncio
+import threading
+
+from asyncio import base_events, events
+
+import pyxul
+
+
+Ci = Components.interfaces
+Cc = Components.classes
+
+
+# ------------------------------------------------------------------------------
+# StreamCallback
+
+class StreamCallback(Interfaces):
+
+    interfaces = [Ci.nsIInputStreamCallback, Ci.nsIOutputStreamCallback]
+
+    def __init__(self, future):
+        self.__future__ = future
+
+    def __ready__(self, stream):
+        if not self.__future__.done():
+            self.__future__.set_result(stream)
+
+    def onInputStreamReady(self, stream):
+        self.__ready__(stream)
+
+    def onOutputStreamReady(self, stream):
+        self.__ready__(stream)
+
+
+# ------------------------------------------------------------------------------
+# EventLoop
+
+class EventLoop(base_events.BaseEventLoop):
+
+    def __init__(self):
+        super().__init__()
+        self.__timers__ = {}
+        self.__target__ = Cc["@mozilla.org/thread-manager;1"].getService(
+            Ci.nsIThreadManager
+        ).mainThread
+
+    def __run__(self, handle):
+        if not handle._cancelled:
+            handle._run()
+
+    def __fire__(self, handle):
+        self.__timers__.pop(handle, None)
+        handle._scheduled = False
+        self.__run__(handle)
+
+    def _timer_handle_cancelled(self, handle):
+        if (timer := self.__timers__.pop(handle, None)):
+            timer.cancel()
+
+    # scheduling
+
+    def call_soon(self, callback, *args, context=None):
+        self._check_closed()
+        if self._debug:
+            self._check_thread()
+            self._check_callback(callback, "call_soon")
+        handle = events.Handle(callback, args, self, context)
+        pyxul.dispatch(self.__run__, handle)
+        return handle
+
+    def call_soon_threadsafe(self, callback, *args, context=None):
+        self._check_closed()
+        if self._debug:
+            self._check_callback(callback, "call_soon_threadsafe")
+        handle = events.Handle(callback, args, self, context)
+        pyxul.dispatch(self.__run__, handle)
+        return handle
+
+    def call_at(self, when, callback, *args, context=None):
+        self._check_closed()
+        if self._debug:
+            self._check_thread()
+            self._check_callback(callback, "call_at")
+        handle = events.TimerHandle(when, callback, args, self, context)
+        self.__timers__[handle] = pyxul.timer(
+            when - self.time(), self.__fire__, handle
+        )
+        handle._scheduled = True
+        return handle
+
+    # streams, in place of readers and writers
+
+    def wait_stream(self, stream):
+        """Return a future done (with stream as result) when the
+        nsIAsyncInputStream or nsIAsyncOutputStream stream is ready or
+        closed."""
+        future = self.create_future()
+        stream.asyncWait(StreamCallback(future), 0, 0, self.__target__)
+        return future
+
+    # running and stopping
+
+    def run_forever(self):
+        raise RuntimeError("the Gecko event loop is always running")
+
+    def run_until_complete(self, future):
+        raise RuntimeError("the Gecko event loop is always running")
+
+    def stop(self):
+        pass
+
+    def close(self):
+        for timer in self.__timers__.values():
+            timer.cancel()
+        self.__timers__.clear()
+        if events._get_running_loop() is self:
+            events._set_running_loop(None)
+        self._thread_id = None
+        super().close()
+
+
+def install():
+    """Make an EventLoop the running loop of the main thread and return
+    it. Calling it again returns the installed loop. There is no way back,
+    pyxul.run_in_background() calls it implicitly."""
+    if threading.current_thread() is not threading.main_thread():
+        raise RuntimeError("install() must be called on the main thread")
+    if not isinstance((loop := events._get_running_loop()), EventLoop):
+        loop = EventLoop()
+        loop._thread_id = threading.get_ident()
+        asyncio.set_event_loop(loop)
+        events._set_running_loop(loop)
+    return loop
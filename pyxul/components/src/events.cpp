@@ -0,0 +1,428 @@
+/*
+# Python for XUL
+# copyright © 2021 Malek Hadj-Ali
+#
+# This program is free software: you can redistribute it and/or modify it
+# under the terms of the GNU General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "events.h"
+
+#include "errors.h"
+#include "python.h"
+
+#include <cmath>
+
+
+namespace pyxul::events {
+
+
+namespace { // anonymous
+
+
+static mozilla::StaticRefPtr<nsIThreadPool> sThreadPool;
+
+
+} // namespace anonymous
+
+
+/* --------------------------------------------------------------------------
+   pyCallback
+   -------------------------------------------------------------------------- */
+
+// calls aCallable(*aArgs), as a runnable or as a timer callback
+class pyCallback final : public nsIRunnable, public nsITimerCallback {
+    public:
+        NS_DECL_THREADSAFE_ISUPPORTS
+        NS_DECL_NSIRUNNABLE
+        NS_DECL_NSITIMERCALLBACK
+
+        pyCallback(PyObject *aCallable, PyObject *aArgs);
+
+    protected:
+        virtual ~pyCallback();
+
+        PyObject *mCallable;
+        PyObject *mArgs;
+};
+
+
+NS_IMPL_ISUPPORTS(pyCallback, nsIRunnable, nsITimerCallback)
+
+
+pyCallback::pyCallback(PyObject *aCallable, PyObject *aArgs)
+{
+    Py_INCREF(aCallable);
+    mCallable = aCallable;
+    Py_INCREF(aArgs);
+    mArgs = aArgs;
+}
+
+
+// may be released from any thread
+pyCallback::~pyCallback()
+{
+    if (Py_IsInitialized()) {
+        AutoGILState ags; // XXX: important
+
+        Py_CLEAR(mArgs);
+        Py_CLEAR(mCallable);
+    }
+}
+
+
+/* interface nsIRunnable ---------------------------------------------------- */
+
+NS_IMETHODIMP
+pyCallback::Run()
+{
+    PyObject *aResult = nullptr;
+
+    if (Py_IsInitialized()) {
+        AutoGILState ags; // XXX: important
+
+        // there is no one to report to, asyncio handles are well behaved
+        if ((aResult = PyObject_Call(mCallable, mArgs, nullptr))) { // +1
+            Py_DECREF(aResult); // -1
+        }
+        else {
+            PyErr_WriteUnraisable(mCallable);
+        }
+    }
+    return NS_OK;
+}
+
+
+/* interface nsITimerCallback ----------------------------------------------- */
+
+NS_IMETHODIMP
+pyCallback::Notify(nsITimer *aTimer)
+{
+    return Run();
+}
+
+
+/* --------------------------------------------------------------------------
+   pyTask
+   -------------------------------------------------------------------------- */
+
+// runs twice: first on the thread pool to call aCallable(*aArgs), then on the
+// main thread to settle aFuture. Only Python objects are handled off the main
+// thread, the result is converted when (and if) it reaches JS
+class pyTask final : public nsIRunnable {
+    public:
+        NS_DECL_THREADSAFE_ISUPPORTS
+        NS_DECL_NSIRUNNABLE
+
+        pyTask(PyObject *aCallable, PyObject *aArgs, PyObject *aFuture);
+
+    protected:
+        virtual ~pyTask();
+
+        void Work();
+        void Convert();
+        void Settle();
+
+        PyObject *mCallable;
+        PyObject *mArgs;
+        PyObject *mFuture;
+        PyObject *mResult;
+        PyObject *mError;
+};
+
+
+NS_IMPL_ISUPPORTS(pyTask, nsIRunnable)
+
+
+pyTask::pyTask(PyObject *aCallable, PyObject *aArgs, PyObject *aFuture)
+    : mResult(nullptr), mError(nullptr)
+{
+    Py_INCREF(aCallable);
+    mCallable = aCallable;
+    Py_INCREF(aArgs);
+    mArgs = aArgs;
+    Py_INCREF(aFuture);
+    mFuture = aFuture;
+}
+
+
+// may be released from any thread, normally Settle() already let go of
+// everything
+pyTask::~pyTask()
+{
+    if (Py_IsInitialized()) {
+        AutoGILState ags; // XXX: important
+
+        Py_CLEAR(mError);
+        Py_CLEAR(mResult);
+        Py_CLEAR(mFuture);
+        Py_CLEAR(mArgs);
+        Py_CLEAR(mCallable);
+    }
+}
+
+
+// on the thread pool
+void
+pyTask::Work()
+{
+    AutoGILState ags; // XXX: important
+
+    PyObject *aType = nullptr, *aValue = nullptr, *aTraceback = nullptr;
+
+    if (!(mResult = PyObject_Call(mCallable, mArgs, nullptr))) { // +1
+        PyErr_Fetch(&aType, &aValue, &aTraceback); // +1
+        PyErr_NormalizeException(&aType, &aValue, &aTraceback);
+        if (aTraceback) {
+            PyException_SetTraceback(aValue, aTraceback);
+        }
+        Py_XDECREF(aTraceback); // -1
+        Py_XDECREF(aType); // -1
+        mError = aValue; // steals the reference
+    }
+}
+
+
+// futures refuse StopIteration, wrap it in a RuntimeError as asyncio does
+void
+pyTask::Convert()
+{
+    PyObject *aError = nullptr;
+
+    if (
+        PyErr_GivenExceptionMatches(mError, PyExc_StopIteration) &&
+        (aError = PyObject_CallFunction(
+            PyExc_RuntimeError, "s", "background call raised StopIteration"
+        )) // +1
+    ) {
+        PyException_SetCause(aError, mError); // steals the reference
+        Py_INCREF(mError);
+        PyException_SetContext(aError, mError); // steals the reference
+        mError = aError; // steals the reference
+    }
+}
+
+
+// on the main thread, a cancelled future is left alone. Everything is
+// released here, where releasing pyjs objects is safe
+void
+pyTask::Settle()
+{
+    AutoGILState ags; // XXX: important
+
+    _Py_IDENTIFIER(done);
+    _Py_IDENTIFIER(set_result);
+    _Py_IDENTIFIER(set_exception);
+    PyObject *aDone = nullptr, *aResult = nullptr;
+
+    if ((aDone = _PyObject_CallMethodIdNoArgs(mFuture, &PyId_done))) { // +1
+        if (aDone == Py_False) {
+            if (mResult) {
+                aResult = _PyObject_CallMethodIdOneArg(
+                    mFuture, &PyId_set_result, mResult
+                ); // +1
+            }
+            else {
+                Convert();
+                aResult = _PyObject_CallMethodIdOneArg(
+                    mFuture, &PyId_set_exception, mError
+                ); // +1
+            }
+            Py_XDECREF(aResult); // -1
+        }
+        Py_DECREF(aDone); // -1
+    }
+    if (PyErr_Occurred()) {
+        PyErr_WriteUnraisable(mFuture);
+    }
+    Py_CLEAR(mError);
+    Py_CLEAR(mResult);
+    Py_CLEAR(mFuture);
+    Py_CLEAR(mArgs);
+    Py_CLEAR(mCallable);
+}
+
+
+/* interface nsIRunnable ---------------------------------------------------- */
+
+NS_IMETHODIMP
+pyTask::Run()
+{
+    if (!Py_IsInitialized()) {
+        return NS_OK;
+    }
+    if (NS_IsMainThread()) {
+        Settle();
+        return NS_OK;
+    }
+    Work();
+    return NS_DispatchToMainThread(this);
+}
+
+
+/* --------------------------------------------------------------------------
+   pyxul::events::Timer
+   -------------------------------------------------------------------------- */
+
+// Timer::Type.tp_dealloc, releasing the last reference cancels an armed timer
+// (the timer thread keeps its own reference to nsITimer until it fires)
+void
+Timer::Dealloc(Timer *self)
+{
+    if (self->mTimer) {
+        self->mTimer->Cancel();
+        NS_RELEASE(self->mTimer);
+    }
+    PyObject_Del(self);
+}
+
+
+// Timer.cancel()
+PyObject *
+Timer::Cancel(Timer *self)
+{
+    if (self->mTimer) {
+        self->mTimer->Cancel();
+    }
+    Py_RETURN_NONE;
+}
+
+
+// Timer::Methods
+PyMethodDef Timer::Methods[] = {
+    {"cancel", (PyCFunction)Timer::Cancel, METH_NOARGS, nullptr},
+    {nullptr} /* Sentinel */
+};
+
+
+// Timer::Type
+PyTypeObject Timer::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul.Timer",
+    .tp_basicsize = sizeof(Timer),
+    .tp_dealloc = (destructor)Timer::Dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_methods = Timer::Methods,
+};
+
+
+/* public ------------------------------------------------------------------- */
+
+PyObject *
+Timer::New(double aDelay, PyObject *aCallable, PyObject *aArgs)
+{
+    nsresult rv = NS_ERROR_FAILURE;
+    uint32_t aMilliseconds = 0;
+    Timer *self = nullptr;
+
+    PY_ENSURE_TRUE(
+        NS_IsMainThread(), nullptr, PyExc_RuntimeError,
+        "timers can only be armed on the main thread"
+    );
+    // round up, a timer firing before its deadline is of no use to asyncio
+    if (aDelay > 0) {
+        aMilliseconds = (uint32_t)std::fmin(std::ceil(aDelay * 1000), UINT32_MAX);
+    }
+    nsCOMPtr<nsITimerCallback> aCallback = new pyCallback(aCallable, aArgs);
+    nsCOMPtr<nsITimer> aTimer = do_CreateInstance(NS_TIMER_CONTRACTID, &rv);
+    PY_ENSURE_SUCCESS(
+        rv, nullptr, errors::XPCOMError, "Failed to create nsITimer"
+    );
+    PY_ENSURE_SUCCESS(
+        aTimer->InitWithCallback(
+            aCallback, aMilliseconds, nsITimer::TYPE_ONE_SHOT
+        ),
+        nullptr, errors::XPCOMError, "Failed to initialize nsITimer"
+    );
+    if ((self = PyObject_New(Timer, &Timer::Type))) {
+        aTimer.forget(&self->mTimer);
+    }
+    else {
+        aTimer->Cancel();
+    }
+    return self;
+}
+
+
+/* --------------------------------------------------------------------------
+   Dispatch
+   -------------------------------------------------------------------------- */
+
+bool
+Dispatch(PyObject *aCallable, PyObject *aArgs)
+{
+    nsCOMPtr<nsIRunnable> aRunnable = new pyCallback(aCallable, aArgs);
+
+    PY_ENSURE_SUCCESS(
+        NS_DispatchToMainThread(aRunnable),
+        false, errors::XPCOMError, "Failed to dispatch to the main thread"
+    );
+    return true;
+}
+
+
+/* --------------------------------------------------------------------------
+   Submit
+   -------------------------------------------------------------------------- */
+
+bool
+Submit(PyObject *aCallable, PyObject *aArgs, PyObject *aFuture)
+{
+    nsresult rv = NS_ERROR_FAILURE;
+
+    PY_ENSURE_TRUE(
+        NS_IsMainThread(), false, PyExc_RuntimeError,
+        "background calls can only be submitted from the main thread"
+    );
+    if (!sThreadPool) {
+        nsCOMPtr<nsIThreadPool> aThreadPool = do_CreateInstance(
+            NS_THREADPOOL_CONTRACTID, &rv
+        );
+        PY_ENSURE_SUCCESS(
+            rv, false, errors::XPCOMError, "Failed to create nsIThreadPool"
+        );
+        aThreadPool->SetName(NS_LITERAL_CSTRING("pyxul"));
+        sThreadPool = aThreadPool;
+    }
+    nsCOMPtr<nsIRunnable> aTask = new pyTask(aCallable, aArgs, aFuture);
+    PY_ENSURE_SUCCESS(
+        sThreadPool->Dispatch(aTask, NS_DISPATCH_NORMAL),
+        false, errors::XPCOMError, "Failed to dispatch to the thread pool"
+    );
+    return true;
+}
+
+
+/* Initialize/Finalize ------------------------------------------------------ */
+
+bool
+Initialize()
+{
+    return !PyType_Ready(&Timer::Type);
+}
+
+
+// workers need the GIL to finish, let go of it while waiting for them
+void
+Finalize()
+{
+    if (sThreadPool) {
+        Py_BEGIN_ALLOW_THREADS
+        sThreadPool->Shutdown();
+        Py_END_ALLOW_THREADS
+        sThreadPool = nullptr;
+    }
+}
+
+
+} // namespace pyxul::events
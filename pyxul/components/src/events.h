@@ -0,0 +1,70 @@
+/*
+# Python for XUL
+# copyright © 2021 Malek Hadj-Ali
+#
+# This program is free software: you can redistribute it and/or modify it
+# under the terms of the GNU General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __pyxul_events_h__
+#define __pyxul_events_h__
+
+
+#include "pyxul/python.h"
+#include "pyxul/xpcom.h"
+
+#include "nsIRunnable.h"
+#include "nsIThreadPool.h"
+#include "nsITimer.h"
+#include "nsThreadUtils.h"
+
+
+namespace pyxul::events {
+
+
+    // a one shot nsITimer calling back into Python, see pyxul.timer()
+    class Timer final : public PyObject {
+        public:
+            static PyTypeObject Type;
+
+            static PyObject *New(
+                double aDelay, PyObject *aCallable, PyObject *aArgs
+            );
+
+        protected:
+            static PyMethodDef Methods[];
+
+            static void Dealloc(Timer *self);
+            static PyObject *Cancel(Timer *self);
+
+        private:
+            nsITimer *mTimer;
+    };
+
+
+    // call aCallable(*aArgs) from the main thread event queue, any thread
+    bool Dispatch(PyObject *aCallable, PyObject *aArgs);
+
+    // call aCallable(*aArgs) on the background thread pool and settle the
+    // asyncio future aFuture with the outcome from the main thread
+    bool Submit(PyObject *aCallable, PyObject *aArgs, PyObject *aFuture);
+
+
+    bool Initialize();
+    void Finalize();
+
+
+} // namespace pyxul::events
+
+
+#endif // __pyxul_events_h__
@@ -19,10 +19,14 @@
 #include "python.h"
 
 #include "errors.h"
+#include "events.h"
 #include "xpc.h"
 
+#include "wrappers/api.h"
+
 
 using namespace pyxul;
+using namespace pyxul::wrappers;
 
 
 /* --------------------------------------------------------------------------
@@ -80,6 +84,197 @@ __showwarning__(PyObject *module, PyObject *args, PyObject *kwargs)
    pyxul module
    -------------------------------------------------------------------------- */
 
+/* signature */
+PyDoc_STRVAR(
+    pyxul_signature_doc,
+    "signature(function, argtypes, restype) -> callable\n\n"
+    "Return a callable calling the JavaScript function with arguments\n"
+    "converted according to argtypes and its result converted to restype.\n"
+    "Types are int, float, bool, str or object (None for restype means\n"
+    "the result is ignored)."
+);
+
+static PyObject *
+pyxul_signature(PyObject *module, PyObject *args)
+{
+    PyObject *function, *argtypes, *restype;
+
+    if (
+        !PyArg_ParseTuple(
+            args, "OOO:signature", &function, &argtypes, &restype
+        )
+    ) {
+        return nullptr;
+    }
+    return pyjs::Signature(function, argtypes, restype);
+}
+
+
+/* js_function */
+PyDoc_STRVAR(
+    pyxul_js_function_doc,
+    "js_function(params, body) -> callable\n\n"
+    "Compile a JavaScript function taking params (a sequence of\n"
+    "identifiers) in the current window's global and return it. Functions\n"
+    "are cached per global and source, compiling the same function twice\n"
+    "is cheap."
+);
+
+static PyObject *
+pyxul_js_function(PyObject *module, PyObject *args)
+{
+    PyObject *params, *body;
+
+    if (!PyArg_ParseTuple(args, "OU:js_function", &params, &body)) {
+        return nullptr;
+    }
+    return xpc::CompileFunction(params, body);
+}
+
+
+/* prefetch */
+PyDoc_STRVAR(
+    pyxul_prefetch_doc,
+    "prefetch(iterable, n=64) -> iterator\n\n"
+    "Return an iterator over iterable that, when consumed from JavaScript,\n"
+    "pulls n items per call into Python and hands them out from a buffer.\n"
+    "Use it for generators yielding many cheap items."
+);
+
+static PyObject *
+pyxul_prefetch(PyObject *module, PyObject *args)
+{
+    PyObject *iterable;
+    Py_ssize_t n = 64;
+
+    if (!PyArg_ParseTuple(args, "O|n:prefetch", &iterable, &n)) {
+        return nullptr;
+    }
+    return jspy::Prefetch(iterable, n);
+}
+
+
+/* dispatch */
+PyDoc_STRVAR(
+    pyxul_dispatch_doc,
+    "dispatch(callback, *args)\n\n"
+    "Call callback(*args) from the main thread event queue. This can be\n"
+    "used from any thread."
+);
+
+static PyObject *
+pyxul_dispatch(PyObject *module, PyObject *args)
+{
+    PyObject *callback, *cbargs;
+    bool result = false;
+
+    PY_ENSURE_TRUE(
+        PyTuple_GET_SIZE(args), nullptr, PyExc_TypeError,
+        "dispatch() missing required argument 'callback'"
+    );
+    callback = PyTuple_GET_ITEM(args, 0); // borrowed
+    PY_ENSURE_TRUE(
+        PyCallable_Check(callback), nullptr, PyExc_TypeError,
+        "'%.200s' object is not callable", Py_TYPE(callback)->tp_name
+    );
+    if ((cbargs = PyTuple_GetSlice(args, 1, PyTuple_GET_SIZE(args)))) { // +1
+        result = events::Dispatch(callback, cbargs);
+        Py_DECREF(cbargs); // -1
+    }
+    if (!result) {
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+
+/* timer */
+PyDoc_STRVAR(
+    pyxul_timer_doc,
+    "timer(delay, callback, *args) -> Timer\n\n"
+    "Call callback(*args) from the main thread event queue once, after\n"
+    "delay seconds (rounded up to the millisecond). The returned timer\n"
+    "has a cancel() method, releasing it also cancels the call. Only\n"
+    "usable on the main thread."
+);
+
+static PyObject *
+pyxul_timer(PyObject *module, PyObject *args)
+{
+    PyObject *delay, *callback, *cbargs, *result = nullptr;
+    double seconds = 0.0;
+
+    PY_ENSURE_TRUE(
+        PyTuple_GET_SIZE(args) > 1, nullptr, PyExc_TypeError,
+        "timer() missing required arguments 'delay' and 'callback'"
+    );
+    delay = PyTuple_GET_ITEM(args, 0); // borrowed
+    callback = PyTuple_GET_ITEM(args, 1); // borrowed
+    if (((seconds = PyFloat_AsDouble(delay)) == -1.0) && PyErr_Occurred()) {
+        return nullptr;
+    }
+    PY_ENSURE_TRUE(
+        PyCallable_Check(callback), nullptr, PyExc_TypeError,
+        "'%.200s' object is not callable", Py_TYPE(callback)->tp_name
+    );
+    if ((cbargs = PyTuple_GetSlice(args, 2, PyTuple_GET_SIZE(args)))) { // +1
+        result = events::Timer::New(seconds, callback, cbargs);
+        Py_DECREF(cbargs); // -1
+    }
+    return result;
+}
+
+
+/* run_in_background */
+PyDoc_STRVAR(
+    pyxul_run_in_background_doc,
+    "run_in_background(fn, *args) -> future\n\n"
+    "Call fn(*args) on a background thread and return an asyncio future\n"
+    "(a Promise once handed to JavaScript) settled from the main thread.\n"
+    "The xpcom_asyncio loop is installed if it isn't already: it stays the\n"
+    "running loop of the main thread from then on, see xpcom_asyncio.\n"
+    "fn must not touch JavaScript objects, args and the outcome are only\n"
+    "released on the main thread."
+);
+
+static PyObject *
+pyxul_run_in_background(PyObject *module, PyObject *args)
+{
+    _Py_IDENTIFIER(install);
+    _Py_IDENTIFIER(create_future);
+    PyObject *fn, *fnargs, *asyncio, *loop, *future = nullptr;
+
+    PY_ENSURE_TRUE(
+        PyTuple_GET_SIZE(args), nullptr, PyExc_TypeError,
+        "run_in_background() missing required argument 'fn'"
+    );
+    fn = PyTuple_GET_ITEM(args, 0); // borrowed
+    PY_ENSURE_TRUE(
+        PyCallable_Check(fn), nullptr, PyExc_TypeError,
+        "'%.200s' object is not callable", Py_TYPE(fn)->tp_name
+    );
+    if (!(fnargs = PyTuple_GetSlice(args, 1, PyTuple_GET_SIZE(args)))) { // +1
+        return nullptr;
+    }
+    if ((asyncio = PyImport_ImportModule("xpcom_asyncio"))) { // +1
+        if ((loop = _PyObject_CallMethodIdNoArgs(asyncio, &PyId_install))) { // +1
+            if (
+                (future = _PyObject_CallMethodIdNoArgs(
+                    loop, &PyId_create_future
+                )) && // +1
+                !events::Submit(fn, fnargs, future)
+            ) {
+                Py_CLEAR(future); // -1
+            }
+            Py_DECREF(loop); // -1
+        }
+        Py_DECREF(asyncio); // -1
+    }
+    Py_DECREF(fnargs); // -1
+    return future;
+}
+
+
 /* pyxul_def.m_methods */
 static PyMethodDef pyxul_m_methods[] = {
     {
@@ -90,6 +285,30 @@ static PyMethodDef pyxul_m_methods[] = {
         "__showwarning__", (PyCFunction)__showwarning__,
         METH_VARARGS | METH_KEYWORDS, __showwarning___doc
     },
+    {
+        "signature", (PyCFunction)pyxul_signature,
+        METH_VARARGS, pyxul_signature_doc
+    },
+    {
+        "js_function", (PyCFunction)pyxul_js_function,
+        METH_VARARGS, pyxul_js_function_doc
+    },
+    {
+        "prefetch", (PyCFunction)pyxul_prefetch,
+        METH_VARARGS, pyxul_prefetch_doc
+    },
+    {
+        "dispatch", (PyCFunction)pyxul_dispatch,
+        METH_VARARGS, pyxul_dispatch_doc
+    },
+    {
+        "timer", (PyCFunction)pyxul_timer,
+        METH_VARARGS, pyxul_timer_doc
+    },
+    {
+        "run_in_background", (PyCFunction)pyxul_run_in_background,
+        METH_VARARGS, pyxul_run_in_background_doc
+    },
     {nullptr} /* Sentinel */
 };
 
@@ -363,6 +582,34 @@ _PyObject_Dir(PyObject *self)
 }
 
 
+// like PyObject_HasAttr() but without evaluating descriptors when the lookup
+// is the generic one (or type's), returns -1 on error
+int
+_PyObject_HasAttrNoEval(PyObject *self, PyObject *name)
+{
+    PyTypeObject *type = Py_TYPE(self);
+    PyObject **dictptr = nullptr;
+
+    if (type->tp_getattro == PyObject_GenericGetAttr) {
+        if (_PyType_Lookup(type, name)) { // borrowed
+            return 1;
+        }
+        if ((dictptr = _PyObject_GetDictPtr(self)) && *dictptr) {
+            return PyDict_Contains(*dictptr, name);
+        }
+        return 0;
+    }
+    if (type->tp_getattro == PyType_Type.tp_getattro) {
+        return (
+            _PyType_Lookup(type, name) || // borrowed
+            _PyType_Lookup((PyTypeObject *)self, name) // borrowed
+        );
+    }
+    // custom lookup (__getattr__, modules, ...), evaluate
+    return PyObject_HasAttr(self, name);
+}
+
+
 PyObject *
 _PySequence_Fast(PyObject *obj, const char *message, Py_ssize_t len)
 {
@@ -415,19 +662,14 @@ _PyMapping_Clear(PyObject *self)
 int
 _PySlice_GetIndices(
     PyObject *slice, Py_ssize_t length,
-    Py_ssize_t *start, Py_ssize_t *stop, Py_ssize_t *slicelength
+    Py_ssize_t *start, Py_ssize_t *stop, Py_ssize_t *step,
+    Py_ssize_t *slicelength
 )
 {
-    Py_ssize_t step;
-
-    if (PySlice_Unpack(slice, start, stop, &step)) {
-        return -1;
-    }
-    if (step != 1) {
-        PyErr_SetString(PyExc_ValueError, "slice step can only be 1");
+    if (PySlice_Unpack(slice, start, stop, step)) {
         return -1;
     }
-    *slicelength = PySlice_AdjustIndices(length, start, stop, step);
+    *slicelength = PySlice_AdjustIndices(length, start, stop, *step);
     return 0;
 }
 
@@ -888,6 +1130,11 @@ _Py_Setup(const char *dist, const char *site)
    initialization/finalization
    -------------------------------------------------------------------------- */
 
+// AutoGILState
+PyThreadState *pyxul::AutoGILState::sMainThreadState = nullptr;
+unsigned int pyxul::AutoGILState::sDepth = 0;
+
+
 static int
 _Py_InitExceptHook(void)
 {
@@ -923,6 +1170,9 @@ _Py_Initialize(void)
     if (!PyImport_ExtendInittab(modules)) {
         Py_InitializeEx(0);
     }
+    if (Py_IsInitialized()) {
+        pyxul::AutoGILState::Initialize();
+    }
     return Py_IsInitialized() ? (_Py_InitExceptHook() ? 0 : 1) : 0;
 }
 
@@ -930,6 +1180,7 @@ _Py_Initialize(void)
 void
 _Py_Finalize(void)
 {
+    pyxul::AutoGILState::Finalize();
     if (Py_FinalizeEx()) {
         fprintf(
             stderr,
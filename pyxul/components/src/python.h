@@ -26,18 +26,69 @@
 namespace pyxul {
 
 
+    // on the main thread, where nearly all crossings happen, skip the
+    // PyGILState machinery: the GIL is either already held by the main thread
+    // state or taken back from the cached one.
+    // The main thread only holds the GIL while crossing: it is released once
+    // Python is initialized, then taken by the outermost crossing and released
+    // again when it returns, so Python threads run while Gecko sits idle.
     class MOZ_STACK_CLASS AutoGILState final {
         public:
-            AutoGILState() {
-                mState = PyGILState_Ensure();
+            AutoGILState() : mMain(false), mRestored(false) {
+                if (
+                    sMainThreadState &&
+                    (PyThread_get_thread_ident() == sMainThreadState->thread_id)
+                ) {
+                    mMain = true;
+                    if (_PyThreadState_UncheckedGet() != sMainThreadState) {
+                        PyEval_RestoreThread(sMainThreadState);
+                        mRestored = true;
+                    }
+                    sDepth++;
+                }
+                else {
+                    mState = PyGILState_Ensure();
+                }
             }
 
             ~AutoGILState() {
-                PyGILState_Release(mState);
+                if (mMain) {
+                    sDepth--;
+                    if (mRestored) {
+                        PyEval_SaveThread();
+                    }
+                }
+                else {
+                    PyGILState_Release(mState);
+                }
+            }
+
+            // number of crossings currently active on the main thread
+            static unsigned int Depth() {
+                return sDepth;
+            }
+
+            // called by the main thread holding the GIL, releases it
+            static void Initialize() {
+                sMainThreadState = PyEval_SaveThread();
+                sDepth = 0;
+            }
+
+            // takes the GIL back for good, before finalizing Python
+            static void Finalize() {
+                if (sMainThreadState) {
+                    PyEval_RestoreThread(sMainThreadState);
+                    sMainThreadState = nullptr;
+                }
             }
 
         private:
             PyGILState_STATE mState;
+            bool mMain;
+            bool mRestored;
+
+            static PyThreadState *sMainThreadState;
+            static unsigned int sDepth;
     };
 
 
@@ -65,6 +116,9 @@ namespace pyxul {
 #define _PyType_IsIterator(tp) \
     (tp->tp_iternext && tp->tp_iternext != &_PyObject_NextNotImplemented)
 
+#define _PyType_IsAsyncIterable(tp) \
+    (tp->tp_as_async && tp->tp_as_async->am_aiter)
+
 #define _PyType_IsMapping(tp) \
     (tp->tp_as_mapping && tp->tp_as_mapping->mp_subscript)
 
@@ -84,13 +138,16 @@ PyObject *_PyObject_Vars(PyObject *self);
 
 PyObject *_PyObject_Dir(PyObject *self);
 
+int _PyObject_HasAttrNoEval(PyObject *self, PyObject *name);
+
 PyObject *_PySequence_Fast(PyObject *obj, const char *message, Py_ssize_t len);
 
 int _PyMapping_Clear(PyObject *self);
 
 int _PySlice_GetIndices(
     PyObject *slice, Py_ssize_t length,
-    Py_ssize_t *start, Py_ssize_t *stop, Py_ssize_t *slicelength
+    Py_ssize_t *start, Py_ssize_t *stop, Py_ssize_t *step,
+    Py_ssize_t *slicelength
 );
 
 int _PyIndex_AsSsize_t(PyObject *index, Py_ssize_t length, Py_ssize_t *result);
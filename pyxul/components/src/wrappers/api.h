@@ -36,9 +36,13 @@ namespace pyxul::wrappers {
             const JS::HandleObject &aThis = nullptr
         );
         PyObject *Wrap(JSContext *aCx, const JS::HandleValue &aJSValue);
+        PyObject *Signature(
+            PyObject *aCallable, PyObject *aArgTypes, PyObject *aResType
+        );
 
 
         bool Initialize();
+        void Finalize();
 
 
     } // namespace pyjs
@@ -50,6 +54,7 @@ namespace pyxul::wrappers {
         bool Check(JS::MutableHandleObject aJSObject);
         JSObject *WrapObject(JSContext *aCx, PyObject *aObject);
         JS::Value Wrap(JSContext *aCx, PyObject *aPyValue);
+        PyObject *Prefetch(PyObject *aIterable, Py_ssize_t aCount);
 
 
         bool Initialize();
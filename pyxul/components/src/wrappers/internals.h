@@ -25,6 +25,8 @@
 
 #include "wrappers/cache.h"
 
+#include "nsClassHashtable.h"
+
 #include "errors.h"
 #include "python.h"
 #include "xpc.h"
@@ -62,18 +64,55 @@ namespace pyxul::wrappers {
     namespace pyjs {
 
 
+        // wrappers::pyjs::NameCache
+        // interned attribute names to pinned jsids, and for each name the
+        // shapes of the last prototype chain it was missing from (until the
+        // next GC)
+        class NameCache final {
+            public:
+                NameCache();
+                ~NameCache();
+
+                bool getId(
+                    JSContext *aCx, PyObject *aName, JS::MutableHandleId aId
+                );
+                bool isMissing(JSObject *aJSObject, PyObject *aName);
+                bool setMissing(
+                    JSContext *aCx, JS::HandleObject aJSObject,
+                    JS::HandleId aId, PyObject *aName
+                );
+                void invalidate();
+                void finalize();
+
+            private:
+                class Entry;
+                typedef nsClassHashtable<nsPtrHashKey<PyObject>, Entry> Table;
+
+                Table mTable;
+                uint32_t mGeneration;
+        };
+
+
         // wrappers::pyjs::Object
         class Object : public PyObject {
             public:
                 static PyTypeObject Type;
 
+                static PyAsyncMethods AsAsync;
                 static PyMethodDef Methods[];
 
+                static NameCache Names;
+
                 class Iterator;
+                class AsyncIterator;
+                class Awaitable;
+                class Entries;
                 class Array;
                 class Map;
                 class Set;
                 class Callable;
+                class Promise;
+                class Signature;
 
                 static PyObject *New(
                     JSContext *aCx, const JS::HandleObject &aJSObject,
@@ -92,7 +131,7 @@ namespace pyxul::wrappers {
                 static PyObject *__repr__(JSContext *aCx, Object *self);
                 static PyObject *__str__(JSContext *aCx, Object *self);
                 static PyObject *__getattr__(
-                    JSContext *aCx, Object *self, const char *aName
+                    JSContext *aCx, Object *self, JS::HandleId aId
                 );
                 static int __setattr__(
                     JSContext *aCx, Object *self, const char *aName,
@@ -125,6 +164,7 @@ namespace pyxul::wrappers {
                 );
                 template<typename T>
                 static PyObject *Iter(Object *self);
+                static PyObject *AIter(Object *self);
                 static void Finalize(Object *self);
 
                 static PyObject *Dir(Object *self);
@@ -150,6 +190,92 @@ namespace pyxul::wrappers {
         };
 
 
+        // wrappers::pyjs::Object::AsyncIterator
+        class Object::AsyncIterator final : public Object {
+            public:
+                static PyTypeObject Type;
+
+                static PyAsyncMethods AsAsync;
+
+            protected:
+                static PyObject *ANext(Object *self);
+        };
+
+
+        // wrappers::pyjs::Object::Awaitable
+        // awaits a promise (or any thenable), from an asyncio task through
+        // one of its loop futures, from a jspy::Task by yielding itself
+        class Object::Awaitable final : public Object {
+            public:
+                static PyTypeObject Type;
+
+                static PyAsyncMethods AsAsync;
+
+                enum Kind {Value, Next};
+
+                static PyObject *New(
+                    JSContext *aCx, const JS::HandleValue &aValue, int aKind
+                );
+                static int Wait(PyObject *aAwaitable, PyObject *aCallback);
+
+            protected:
+                enum State {Pending, Fulfilled, Rejected, Done};
+
+                static bool __settle__(
+                    JSContext *aCx, Awaitable *self, bool aFulfilled,
+                    JS::HandleValue aValue
+                );
+                static PyObject *__wait__(Awaitable *self);
+
+                static bool Settle(JSContext *aCx, unsigned argc, JS::Value *vp);
+
+                static PyObject *Await(Awaitable *self);
+                static PyObject *Next(Awaitable *self);
+                static void Finalize(Awaitable *self);
+
+            private:
+                PyObject *mResult; // value or exception
+                PyObject *mWaiters; // callbacks
+                int mKind;
+                int mState;
+        };
+
+
+        // wrappers::pyjs::Object::Entries
+        // iterates over the keys, values or items of a Map or Set, reading
+        // them a chunk at a time
+        class Object::Entries final : public Object {
+            public:
+                static PyTypeObject Type;
+
+                enum Kind {Keys, Values, Items};
+
+                static PyObject *New(
+                    JSContext *aCx, const JS::HandleValue &aIterator, int aKind
+                );
+                static bool __read__(
+                    JSContext *aCx, const JS::HandleValue &aIterator,
+                    uint32_t aCount, JS::AutoValueVector &aValues, bool *aDone
+                );
+                static PyObject *__item__(
+                    JSContext *aCx, int aKind, const JS::HandleValue &aValue
+                );
+
+            protected:
+                static bool __fetch__(JSContext *aCx, Entries *self);
+
+                static PyObject *Next(Entries *self);
+                static void Finalize(Entries *self);
+
+            private:
+                PyObject *mItems; // current chunk
+                Py_ssize_t mPos; // position in the current chunk
+                uint32_t mChunk; // size of the next chunk
+                int mKind;
+                bool mDone;
+        };
+
+
         // wrappers::pyjs::Object::Array
         class Object::Array final : public Object {
             public:
@@ -158,6 +284,8 @@ namespace pyxul::wrappers {
                 static PySequenceMethods AsSequence;
                 static PyMappingMethods AsMapping;
 
+                class Iterator;
+
             protected:
                 static Py_ssize_t __len__(JSContext *aCx, Object *self);
                 static PyObject *__getitem__(
@@ -199,27 +327,69 @@ namespace pyxul::wrappers {
                 static PyObject *RichCompare(
                     Object *self, PyObject *aOther, int op
                 );
+                static PyObject *Iter(Object *self);
             private:
                 static bool __check__(PyObject *aOther);
                 static PyObject *__getElement__(
                     JSContext *aCx, Object *self, uint32_t aIdx
                 );
+                static bool __readElements__(
+                    JSContext *aCx, Object *self, uint32_t aStart, uint32_t aEnd,
+                    JS::AutoValueVector &aValues
+                );
                 static int __setElement__(
                     JSContext *aCx, Object *self, uint32_t aIdx, PyObject *aValue
                 );
+                static bool __writeElements__(
+                    JSContext *aCx, JS::HandleObject aJSObject, uint32_t aStart,
+                    JS::AutoValueVector &aValues
+                );
+                static bool __moveElements__(
+                    JSContext *aCx, Object *self, uint32_t aTo, uint32_t aFrom,
+                    uint32_t aEnd
+                );
+                static bool __repeatElements__(
+                    JSContext *aCx, Object *self, uint32_t aLen,
+                    JS::HandleObject aJSObject, uint32_t aStart,
+                    uint32_t aCount
+                );
                 static PyObject *__getElements__(
-                    JSContext *aCx, Object *self, uint32_t aStart, uint32_t aCount
+                    JSContext *aCx, Object *self, uint32_t aStart,
+                    Py_ssize_t aStep, uint32_t aCount
                 );
                 static int __setElements__(
-                    JSContext *aCx, Object *self, uint32_t aStart, uint32_t aCount,
-                    PyObject *aValue
+                    JSContext *aCx, Object *self, uint32_t aStart,
+                    Py_ssize_t aStep, uint32_t aCount, PyObject *aValue
                 );
                 static int __delElements__(
-                    JSContext *aCx, Object *self, uint32_t aStart, uint32_t aCount
+                    JSContext *aCx, Object *self, uint32_t aStart,
+                    Py_ssize_t aStep, uint32_t aCount
                 );
         };
 
 
+        // wrappers::pyjs::Object::Array::Iterator
+        // walks the indices of an array, reading its elements a chunk at a
+        // time
+        class Object::Array::Iterator final : public Object {
+            public:
+                static PyTypeObject Type;
+
+            protected:
+                static bool __fetch__(JSContext *aCx, Iterator *self);
+
+                static PyObject *Next(Iterator *self);
+                static void Finalize(Iterator *self);
+
+            private:
+                PyObject *mItems; // current chunk
+                Py_ssize_t mPos; // position in the current chunk
+                uint32_t mIndex; // index of the next chunk
+                uint32_t mChunk; // size of the next chunk
+                bool mDone;
+        };
+
+
         // wrappers::pyjs::Object::Map
         class Object::Map final : public Object {
             public:
@@ -228,9 +398,17 @@ namespace pyxul::wrappers {
                 static PySequenceMethods AsSequence;
                 static PyMappingMethods AsMapping;
 
+                static PyMethodDef Methods[];
+
+                class View;
+
                 static bool __iter__(
                     JSContext* aCx, Object *self, JS::MutableHandleValue aResult
                 );
+                static bool __entries__(
+                    JSContext* aCx, Object *self, int aKind,
+                    JS::MutableHandleValue aResult
+                );
 
             protected:
                 static PyObject *__getitem__(
@@ -262,11 +440,41 @@ namespace pyxul::wrappers {
                 static PyObject *RichCompare(
                     Object *self, PyObject *aOther, int op
                 );
+                static PyObject *GetAttrO(Object *self, PyObject *aName);
+                static PyObject *Iter(Object *self);
+
+                static PyObject *Keys(Object *self);
+                static PyObject *Values(Object *self);
+                static PyObject *Items(Object *self);
             private:
                 static bool __check__(PyObject *aOther);
         };
 
 
+        // wrappers::pyjs::Object::Map::View
+        // keys(), values() and items() of a Map
+        class Object::Map::View final : public Object {
+            public:
+                static PyTypeObject Type;
+
+                static PySequenceMethods AsSequence;
+
+                static PyObject *New(Object *aMap, int aKind);
+
+            protected:
+                static int __contains__(
+                    JSContext *aCx, View *self, PyObject *aValue
+                );
+
+                static Py_ssize_t Length(View *self);
+                static int Contains(View *self, PyObject *aValue);
+                static PyObject *Iter(View *self);
+
+            private:
+                int mKind;
+        };
+
+
         // wrappers::pyjs::Object::Set
         class Object::Set final : public Object {
             public:
@@ -283,22 +491,27 @@ namespace pyxul::wrappers {
 
             protected:
                 static int __sub__(
-                    JSContext *aCx, PyObject *aOther,
+                    JSContext *aCx, JS::HandleObject aOther,
                     JS::MutableHandleObject aResult
                 );
                 static int __and__(
-                    JSContext *aCx, PyObject *aOther,
+                    JSContext *aCx, JS::HandleObject aOther,
                     JS::MutableHandleObject aResult
                 );
                 static int __xor__(
-                    JSContext *aCx, PyObject *aOther,
+                    JSContext *aCx, JS::HandleObject aOther,
                     JS::MutableHandleObject aResult
                 );
                 static int __or__(
-                    JSContext *aCx, PyObject *aOther,
+                    JSContext *aCx, JS::HandleObject aOther,
                     JS::MutableHandleObject aResult
                 );
 
+                static int __in__(
+                    JSContext *aCx, JS::HandleObject aSet,
+                    JS::HandleObject aOther
+                );
+
                 static PyObject *__le__(
                     JSContext *aCx, Object *self, PyObject *aOther
                 );
@@ -320,6 +533,7 @@ namespace pyxul::wrappers {
                 static PyObject *RichCompare(
                     Object *self, PyObject *aOther, int op
                 );
+                static PyObject *Iter(Object *self);
 
                 static PyObject *IsDisjoint(Object *self, PyObject *aOther);
                 static PyObject *IsSubset(Object *self, PyObject *aOther);
@@ -330,6 +544,14 @@ namespace pyxul::wrappers {
                 static PyObject *Union(Object *self, PyObject *args);
             private:
                 static bool __check__(PyObject *aOther);
+                static bool __set__(
+                    JSContext *aCx, PyObject *aOther,
+                    JS::MutableHandleObject aResult
+                );
+                static bool __values__(
+                    JSContext *aCx, JS::HandleObject aSet,
+                    JS::AutoValueVector &aValues
+                );
                 static JSObject *__copy__(JSContext *aCx, Object *self);
         };
 
@@ -355,6 +577,49 @@ namespace pyxul::wrappers {
         };
 
 
+        // wrappers::pyjs::Object::Promise
+        class Object::Promise final : public Object {
+            public:
+                static PyTypeObject Type;
+
+                static PyAsyncMethods AsAsync;
+
+            protected:
+                static PyObject *Await(Object *self);
+        };
+
+
+        // wrappers::pyjs::Object::Signature
+        // a JS function with fixed argument and result types, see
+        // pyxul.signature()
+        class Object::Signature final : public Object {
+            public:
+                static PyTypeObject Type;
+
+                static PyObject *New(
+                    PyObject *aCallable, PyObject *aArgTypes, PyObject *aResType
+                );
+
+            protected:
+                static char __code__(PyObject *aType, bool result);
+                static JS::Value __arg__(
+                    JSContext *aCx, char code, PyObject *aValue
+                );
+                static PyObject *__result__(
+                    JSContext *aCx, char code, JS::HandleValue aValue
+                );
+
+                static PyObject *Repr(Signature *self);
+                static PyObject *Call(
+                    Signature *self, PyObject *aArgs, PyObject *aKwargs
+                );
+                static void Finalize(Signature *self);
+
+            private:
+                PyObject *mCodes; // result code followed by argument codes
+        };
+
+
         PyObject *WrapString(JSContext *aCx, const JS::HandleString &aJSString);
         PyObject *WrapSymbol(JSContext *aCx, const JS::HandleSymbol &aJSSymbol);
         PyObject *WrapId(JSContext *aCx, jsid aId);
@@ -374,14 +639,209 @@ namespace pyxul::wrappers {
         };
 
 
+        // wrappers::jspy::Slots
+        // per Python type attribute metadata, valid as long as the type's
+        // tp_version_tag doesn't change, and the accessor and method functions
+        class Slots final {
+            public:
+                Slots();
+                ~Slots();
+
+                enum Kind : int {
+                    Unknown = 0,
+                    Attribute, // anything but a plain method in the type
+                    Method, // function or method_descriptor in the type
+                    Missing // nothing in the type
+                };
+
+                bool Init(PyTypeObject *aType);
+                void Clear();
+
+                // reserved slots of the accessor functions
+                enum : size_t {
+                    AccessorId = 0,
+                    AccessorName // holds the interned name, see GetName()
+                };
+
+                // reserved slots of the method functions
+                enum : size_t {
+                    MethodName = 0, // holds the interned name, see GetName()
+                    MethodSelf // the wrapper the method is bound to
+                };
+
+                int GetKind(PyObject *aName);
+
+                static JSObject *GetGetter(
+                    JSContext *aCx, JS::HandleId aId, PyObject *aName
+                );
+                static JSObject *GetSetter(
+                    JSContext *aCx, JS::HandleId aId, PyObject *aName
+                );
+                static JSObject *NewMethod(
+                    JSContext *aCx, JS::HandleId aId, PyObject *aName,
+                    JS::HandleObject self
+                );
+                static PyObject *GetName(JSObject *aFunction, size_t aSlot);
+                static PyObject *LookupMethod(PyObject *aObject, PyObject *aName);
+
+                static bool Initialize(JSContext *aCx);
+                static void Finalize();
+
+            private:
+                class Slot;
+                typedef nsClassHashtable<nsPtrHashKey<PyObject>, Slot> Table;
+
+                PyTypeObject *mType;
+                unsigned int mVersionTag;
+                Table mTable;
+
+                bool Check(PyObject *aName);
+                Slot *Ensure(PyObject *aName);
+
+                static JSObject *__function__(
+                    JSContext *aCx, JS::HandleId aId, JSNative aNative,
+                    JS::HandleValue aFirst, JS::HandleValue aSecond
+                );
+                static JSObject *__cached__(
+                    JSContext *aCx, JS::HandleId aId, PyObject *aName,
+                    JSNative aNative
+                );
+        };
+
+
+        // wrappers::jspy::Walker
+        // lazily walks the keys, values or entries of a dict, list, tuple or
+        // set, fails if the container changes size meanwhile
+        class Walker final : public PyObject {
+            public:
+                static PyTypeObject Type;
+
+                static PyObject *New(PyObject *aObject, int aType);
+
+            protected:
+                static PyObject *__dict__(Walker *self);
+                static PyObject *__sequence__(Walker *self);
+                static PyObject *__set__(Walker *self);
+                static PyObject *__entry__(
+                    Walker *self, PyObject *aKey, PyObject *aValue
+                );
+
+                static void Dealloc(Walker *self);
+                static int Traverse(Walker *self, visitproc visit, void *arg);
+                static PyObject *Next(Walker *self);
+
+            private:
+                PyObject *mObject;
+                Py_ssize_t mPos;
+                Py_ssize_t mSize;
+                int mType;
+        };
+
+
+        // wrappers::jspy::Prefetcher
+        // a Python iterator pulling mCount items per crossing when consumed
+        // from JS, next() only takes the GIL once its buffer is drained
+        class Prefetcher final : public PyObject {
+            public:
+                static PyTypeObject Type;
+                static const js::Class Class;
+                static const JSFunctionSpec Functions[];
+                static JS::PersistentRootedObject Proto;
+
+                static PyObject *New(PyObject *aIterable, Py_ssize_t aCount);
+                static JSObject *Alloc(JSContext *aCx, PyObject *aObject);
+
+            protected:
+                enum : uint32_t {
+                    BufferSlot = 0,
+                    IndexSlot,
+                    LengthSlot,
+                    DoneSlot,
+                    ReservedSlots
+                };
+
+                static const js::ClassOps ClassOps;
+
+                static bool __fill__(JSContext *aCx, JS::HandleObject self);
+
+                static void Dealloc(Prefetcher *self);
+                static int Traverse(Prefetcher *self, visitproc visit, void *arg);
+                static PyObject *Next(Prefetcher *self);
+
+                static void Finalize(js::FreeOp *fop, JSObject *self);
+                static bool GetIterator(JSContext *aCx, unsigned argc, JS::Value *vp);
+                static bool __next__(JSContext *aCx, unsigned argc, JS::Value *vp);
+
+            private:
+                PyObject *mIter;
+                size_t mCount;
+                PyObject *mErrType;
+                PyObject *mErrValue;
+                PyObject *mErrTraceback;
+        };
+
+
+        // wrappers::jspy::Task
+        // drives a Python awaitable from JS and settles a promise with its
+        // outcome, resumed by promise reactions or asyncio futures
+        class Task final : public PyObject {
+            public:
+                static PyTypeObject Type;
+
+                enum Kind : int {
+                    Result = 0, // resolve with the value
+                    Next, // resolve with {value, done}
+                    Return // resolve with {undefined, true}
+                };
+
+                static JSObject *New(
+                    JSContext *aCx, PyObject *aAwaitable, int aKind
+                );
+                static JSObject *Get(JSContext *aCx, PyObject *aAwaitable);
+                static void Finalize();
+
+            protected:
+                static bool __resolve__(
+                    JSContext *aCx, Task *self, PyObject *aValue
+                );
+                static bool __reject__(JSContext *aCx, Task *self);
+                static void __done__(Task *self);
+                static bool __wait__(
+                    JSContext *aCx, Task *self, PyObject *aYielded
+                );
+                static void __step__(JSContext *aCx, Task *self);
+
+                static void Dealloc(Task *self);
+                static int Traverse(Task *self, visitproc visit, void *arg);
+                static PyObject *Call(
+                    Task *self, PyObject *args, PyObject *kwargs
+                );
+
+            private:
+                PyObject *mIter;
+                JS::PersistentRootedObject *mPromise; // until settled
+                int mKind;
+        };
+
+
+        class SlotCache final : public Cache<PyTypeObject, Slots> {
+            public:
+                Slots *ensure(PyTypeObject *aType);
+                void discard(PyTypeObject *aType);
+                void finalizeObject(PyTypeObject *aKey, Slots *aData) override;
+        };
+
+
         // wrappers::jspy::Object
         class Object {
             friend class ObjectCache;
+            friend class Slots;
 
             public:
                 static const js::Class Class;
 
                 static ObjectCache Objects;
+                static SlotCache TypeSlots;
 
                 class Sequence;
                 class Callable;
@@ -390,6 +850,11 @@ namespace pyxul::wrappers {
                 static PyObject *Unwrap(const JS::HandleObject &aJSObject);
 
             protected:
+                enum : uint32_t {
+                    MethodsSlot = 0, // bound method functions, by jsid
+                    ReservedSlots
+                };
+
                 static const js::ClassOps ClassOps;
                 static const js::ClassExtension ClassExtension;
                 static const js::ObjectOps ObjectOps;
@@ -402,6 +867,14 @@ namespace pyxul::wrappers {
                     JSContext *aCx, JS::HandleObject self, JS::HandleId aId,
                     JS::MutableHandleValue aResult
                 );
+                static bool __getattr__(
+                    JSContext *aCx, JS::HandleObject self, JS::HandleId aId,
+                    PyObject *aName, JS::MutableHandleValue aResult
+                );
+                static PyObject *__lookup__(
+                    JSContext *aCx, JS::HandleObject self, JS::HandleId aId,
+                    PyObject *aName, JS::MutableHandleValue aResult
+                );
                 static bool __setattr__(
                     JSContext* aCx, JS::HandleObject self, JS::HandleId aId,
                     JS::HandleValue aValue
@@ -409,6 +882,14 @@ namespace pyxul::wrappers {
                 static bool __delattr__(
                     JSContext *aCx, JS::HandleObject self, JS::HandleId aId
                 );
+                static bool __method__(
+                    JSContext *aCx, JS::HandleObject self, JS::HandleId aId,
+                    PyObject *aName, JS::MutableHandleValue aResult
+                );
+                static bool __define__(
+                    JSContext *aCx, JS::HandleObject self, JS::HandleId aId,
+                    PyObject *aName
+                );
 
                 template<typename T>
                 static JSObject *Alloc(
@@ -423,6 +904,9 @@ namespace pyxul::wrappers {
                 static void Finalize(js::FreeOp *fop, JSObject *self);
                 static bool Call(JSContext *aCx, unsigned argc, JS::Value *vp);
                 static void Moved(JSObject *self, const JSObject *old);
+                static bool Getter(JSContext *aCx, unsigned argc, JS::Value *vp);
+                static bool Setter(JSContext *aCx, unsigned argc, JS::Value *vp);
+                static bool Method(JSContext *aCx, unsigned argc, JS::Value *vp);
 
                 static bool GetPropertyOp(
                     JSContext* aCx, JS::HandleObject self, JS::HandleValue rec,
@@ -506,6 +990,7 @@ namespace pyxul::wrappers {
                 static JS::PersistentRootedObject ProtoBase;
 
                 class Iterator;
+                class AsyncIterator;
                 class Mapping;
                 class Sequence;
                 class Set;
@@ -534,6 +1019,9 @@ namespace pyxul::wrappers {
                 static bool __map__(
                     JSContext *aCx, JS::CallArgs &args, PyObject *aObject
                 );
+                static bool __walk__(
+                    JSContext *aCx, JS::CallArgs &args, PyObject *aObject
+                );
 
                 template<typename T>
                 static JSObject *Alloc(
@@ -591,18 +1079,37 @@ namespace pyxul::wrappers {
                 static const JSFunctionSpec Functions[];
                 static const JSPropertySpec Properties[];
 
+                static const JSFunctionSpec LegacyFunctions[];
+                static JS::PersistentRootedObject LegacyProto;
+
+                static JSObject *New(
+                    JSContext *aCx, PyObject *aIter, bool legacy
+                );
+
             protected:
                 static bool __wrap__(
                     JSContext *aCx, JS::CallArgs &args, PyObject *aObject
                 );
 
                 static bool GetIterator(JSContext *aCx, unsigned argc, JS::Value *vp);
-                static bool Next(JSContext *aCx, unsigned argc, JS::Value *vp);
                 static bool __next__(JSContext *aCx, unsigned argc, JS::Value *vp);
                 static bool __legacy__(JSContext *aCx, unsigned argc, JS::Value *vp);
         };
 
 
+        // wrappers::jspy::Type::AsyncIterator
+        class Type::AsyncIterator final : public Type {
+            public:
+                static const JSFunctionSpec Functions[];
+                static const JSPropertySpec Properties[];
+
+            protected:
+                static bool GetAsyncIterator(JSContext *aCx, unsigned argc, JS::Value *vp);
+                static bool Next(JSContext *aCx, unsigned argc, JS::Value *vp);
+                static bool Return(JSContext *aCx, unsigned argc, JS::Value *vp);
+        };
+
+
         // wrappers::jspy::Type::Mapping
         class Type::Mapping final : public Type {
             public:
@@ -690,17 +1197,40 @@ namespace pyxul::wrappers {
 #define JSPY_BASE_OBJECT_OPS \
     .enumerate = Enumerate,
 
+// with PYXUL_JSPY_ACCESSORS, Resolve defines real accessor properties, plain
+// objects must not hide them behind a getProperty op (or ICs never attach)
+#ifdef PYXUL_JSPY_ACCESSORS
+#define JSPY_GET_PROPERTY_OP
+#else
+#define JSPY_GET_PROPERTY_OP \
+    .getProperty = GetPropertyOp,
+#endif
+
 #define JSPY_OBJECT_OBJECT_OPS  \
+    JSPY_GET_PROPERTY_OP \
+    .setProperty = SetPropertyOp, \
+    .deleteProperty = DeletePropertyOp,\
+    JSPY_BASE_OBJECT_OPS
+
+#define JSPY_SEQUENCE_OBJECT_OPS  \
     .getProperty = GetPropertyOp, \
     .setProperty = SetPropertyOp, \
     .deleteProperty = DeletePropertyOp,\
     JSPY_BASE_OBJECT_OPS
 
 
+// accessor properties defined by Resolve
+#define JSPY_ACCESSOR_FLAGS \
+    (JSPROP_SHARED | JSPROP_GETTER | JSPROP_SETTER | JSPROP_RESOLVING)
+
+
 // Class
 #define JSPY_CLASS(n) \
     .name = n, \
-    .flags = (JSCLASS_HAS_PRIVATE |JSCLASS_FOREGROUND_FINALIZE), \
+    .flags = ( \
+        JSCLASS_HAS_PRIVATE | JSCLASS_FOREGROUND_FINALIZE | \
+        JSCLASS_HAS_RESERVED_SLOTS(ReservedSlots) \
+    ), \
     .cOps = &ClassOps, \
     .ext = &ClassExtension, \
     .oOps = &ObjectOps,
@@ -102,6 +102,20 @@ WrapValue(JSContext *aCx, PyObject *aValue)
 }
 
 
+// asyncio compatible futures, see asyncio.isfuture()
+static bool
+__isfuture__(PyObject *aObject)
+{
+    _Py_IDENTIFIER(_asyncio_future_blocking);
+    PyTypeObject *type = Py_TYPE(aObject);
+
+    return (
+        type->tp_as_async && type->tp_as_async->am_await &&
+        _PyType_LookupId(type, &PyId__asyncio_future_blocking) // borrowed
+    );
+}
+
+
 } // namespace anonymous
 
 
@@ -204,8 +218,17 @@ WrapObject(JSContext *aCx, PyObject *aObject)
 {
     JS::RootedObject aResult(aCx);
 
-    if (!(aResult = pyjs::Unwrap(aObject))) {
-        aResult = Object::New(aCx, aObject);
+    if (Py_IS_TYPE(aObject, &Prefetcher::Type)) {
+        aResult = Prefetcher::Alloc(aCx, aObject);
+    }
+    else if (!(aResult = pyjs::Unwrap(aObject))) {
+        // coroutines and futures become promises
+        if (PyCoro_CheckExact(aObject) || __isfuture__(aObject)) {
+            aResult = Task::Get(aCx, aObject);
+        }
+        else {
+            aResult = Object::New(aCx, aObject);
+        }
     }
     return aResult;
 }
@@ -238,11 +261,26 @@ Wrap(JSContext *aCx, PyObject *aValue)
 }
 
 
+PyObject *
+Prefetch(PyObject *aIterable, Py_ssize_t aCount)
+{
+    return Prefetcher::New(aIterable, aCount);
+}
+
+
 /* Initialize/Finalize ------------------------------------------------------ */
 
 bool
 Initialize(void)
 {
+    if (
+        PyType_Ready(&Walker::Type) ||
+        PyType_Ready(&Prefetcher::Type) ||
+        PyType_Ready(&Task::Type)
+    ) {
+        return false;
+    }
+
     AutoJSContext aCx;
     AutoReporter ar(aCx);
 
@@ -255,15 +293,42 @@ Initialize(void)
     );
     Object::Objects.put(aTypeBase, Type::ProtoBase);
 
-    return true;
+    // init legacy iterator prototype
+    JS::RootedObject aLegacyProto(aCx, JS_NewPlainObject(aCx));
+    PY_ENSURE_TRUE(
+        (
+            aLegacyProto &&
+            JS_DefineFunctions(aCx, aLegacyProto, Type::Iterator::LegacyFunctions)
+        ), false,
+        errors::JSError, "Failed to create legacy iterator prototype"
+    );
+    Type::Iterator::LegacyProto.init(aCx, aLegacyProto);
+
+    // init prefetch prototype
+    JS::RootedObject aPrefetchProto(aCx, JS_NewPlainObject(aCx));
+    PY_ENSURE_TRUE(
+        (
+            aPrefetchProto &&
+            JS_DefineFunctions(aCx, aPrefetchProto, Prefetcher::Functions)
+        ), false,
+        errors::JSError, "Failed to create prefetch prototype"
+    );
+    Prefetcher::Proto.init(aCx, aPrefetchProto);
+
+    return Slots::Initialize(aCx);
 }
 
 
 void
 Finalize(void)
 {
+    Prefetcher::Proto.reset();
+    Type::Iterator::LegacyProto.reset();
     Type::ProtoBase.reset();
 
+    Task::Finalize();
+    Slots::Finalize();
+    Object::TypeSlots.finalize();
     Object::Objects.finalize();
 }
 
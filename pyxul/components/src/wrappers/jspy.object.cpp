@@ -26,30 +26,161 @@ namespace pyxul::wrappers::jspy {
 namespace { // anonymous
 
 
-// nameToId
+// namesToIds, walks aDict in place, names go through the pyjs name cache
 static bool
-__name2id__(JSContext *aCx, PyObject *aName, JS::MutableHandleId aId)
+__dict2ids__(JSContext *aCx, JS::AutoIdVector &aIds, PyObject *aDict)
 {
-    JS::RootedValue aJSName(aCx, WrapUnicode(aCx, aName));
-    return aJSName.isUndefined() ? false : JS_ValueToId(aCx, aJSName, aId);
+    JS::RootedId aId(aCx);
+    PyObject *aKey = nullptr, *aValue = nullptr;
+    Py_ssize_t pos = 0;
+    bool result = true;
+
+    if (!aIds.reserve(aIds.length() + PyDict_GET_SIZE(aDict))) {
+        PyErr_NoMemory();
+        return false;
+    }
+    Py_INCREF(aDict); // +1
+    while (PyDict_Next(aDict, &pos, &aKey, &aValue)) { // borrowed
+        // getId can GC, and jspy finalizers can run Python code
+        Py_INCREF(aKey); // +1
+        result = pyjs::Object::Names.getId(aCx, aKey, &aId);
+        Py_DECREF(aKey); // -1
+        if (!result) {
+            break;
+        }
+        if (!(result = aIds.append(aId))) {
+            PyErr_NoMemory();
+            break;
+        }
+    }
+    Py_DECREF(aDict); // -1
+    return result;
 }
 
 
-// mergeNamesToIds
+// slotsToIds, the __slots__ of aObject's type (and bases) that are set
 static bool
-__merge__(JSContext *aCx, JS::AutoIdVector &aIds, PyObject *aNames)
+__slots2ids__(JSContext *aCx, JS::AutoIdVector &aIds, PyObject *aObject)
 {
     JS::RootedId aId(aCx);
-    Py_ssize_t size = PyList_GET_SIZE(aNames), i;
-
+    PyTypeObject *aType = Py_TYPE(aObject), *aBase = nullptr;
+    PyObject *aMro = aType->tp_mro, *aSlots = nullptr, *aName = nullptr;
+    PyObject *aDescr = nullptr;
+    PyMemberDef *aMember = nullptr;
+    Py_ssize_t size = 0, count = 0, i, j;
+
+    if (aMro) {
+        size = PyTuple_GET_SIZE(aMro);
+    }
     for (i = 0; i < size; i++) {
+        aBase = (PyTypeObject *)PyTuple_GET_ITEM(aMro, i); // borrowed
         if (
-            !__name2id__(aCx, PyList_GET_ITEM(aNames, i), &aId) ||
-            !aIds.append(aId)
+            !PyType_HasFeature(aBase, Py_TPFLAGS_HEAPTYPE) ||
+            !(aSlots = ((PyHeapTypeObject *)aBase)->ht_slots)
         ) {
+            continue;
+        }
+        count = PyTuple_GET_SIZE(aSlots);
+        for (j = 0; j < count; j++) {
+            aName = PyTuple_GET_ITEM(aSlots, j); // borrowed
+            // skip slots shadowed further down the mro
+            if (
+                !(aDescr = _PyType_Lookup(aType, aName)) || // borrowed
+                !Py_IS_TYPE(aDescr, &PyMemberDescr_Type) ||
+                (PyDescr_TYPE(aDescr) != aBase)
+            ) {
+                continue;
+            }
+            aMember = ((PyMemberDescrObject *)aDescr)->d_member;
+            // unset slots raise AttributeError, don't list them
+            if (!*(PyObject **)((char *)aObject + aMember->offset)) {
+                continue;
+            }
+            if (!pyjs::Object::Names.getId(aCx, aName, &aId)) {
+                return false;
+            }
+            if (!aIds.append(aId)) {
+                PyErr_NoMemory();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+// forward to the first object on aObject's prototype chain that has aId
+static bool
+__forward__(
+    JSContext *aCx, JS::HandleObject aObject, JS::HandleId aId,
+    JS::HandleValue rec, JS::MutableHandleValue aResult
+)
+{
+    bool result = false;
+    PyObject *err_type = nullptr, *err_inst = nullptr, *err_trbk = nullptr;
+
+    PyErr_Fetch(&err_type, &err_inst, &err_trbk);
+    JS::Rooted<JS::PropertyDescriptor> desc(aCx);
+    if ((result = JS_GetPropertyDescriptorById(aCx, aObject, aId, &desc))) {
+        JS::RootedObject aHolder(aCx, desc.object());
+        if (!aHolder) {
+            PyErr_Restore(err_type, err_inst, err_trbk);
+            result = false;
+        }
+        else {
+            Py_XDECREF(err_trbk);
+            Py_XDECREF(err_inst);
+            Py_XDECREF(err_type);
+            result = JS_ForwardGetPropertyTo(aCx, aHolder, aId, rec, aResult);
+        }
+    }
+    else {
+        PyErr_Restore(err_type, err_inst, err_trbk);
+    }
+    return result;
+}
+
+
+// only plain objects get accessors, the others keep their getProperty hooks
+static bool
+__accessible__(JSObject *aJSObject)
+{
+    const js::Class *aClass = js::GetObjectClass(aJSObject);
+
+    return (aClass == &Object::Class || aClass == &Object::Callable::Class);
+}
+
+
+// the id of an accessor call and the wrapper holding the accessor, this or
+// one of its prototypes
+static bool
+__accessor__(
+    JSContext *aCx, const JS::CallArgs &args, JS::MutableHandleId aId,
+    JS::MutableHandleObject aResult
+)
+{
+    JS::RootedValue aJSId(
+        aCx, js::GetFunctionNativeReserved(&args.callee(), Slots::AccessorId)
+    );
+    if (!args.thisv().isObject() || !JS_ValueToId(aCx, aJSId, aId)) {
+        PyErr_SetString(PyExc_TypeError, "invalid accessor call");
+        return false;
+    }
+    JS::RootedObject aBase(aCx);
+    aResult.set(xpc::Unwrap(&args.thisv().toObject()));
+    while (aResult && !__accessible__(aResult)) {
+        aBase = aResult;
+        if (!JS_GetPrototype(aCx, aBase, aResult)) {
             return false;
         }
+        if (aResult) {
+            aResult.set(xpc::Unwrap(aResult));
+        }
     }
+    PY_ENSURE_TRUE(
+        aResult, false,
+        PyExc_TypeError, "accessor called on incompatible object"
+    );
     return true;
 }
 
@@ -125,20 +256,133 @@ Object::__getattr__(
 )
 {
     bool result = false;
-    PyObject *aName = nullptr, *aPyResult = nullptr;
+    PyObject *aName = nullptr;
 
     if ((aName = pyjs::WrapId(aCx, aId))) { // +1
-        if ((aPyResult = PyObject_GetAttr(__unwrap__(self), aName))) { // +1
+        PyUnicode_InternInPlace(&aName);
+        result = __getattr__(aCx, self, aId, aName, aResult);
+        Py_DECREF(aName); // -1
+    }
+    return result;
+}
+
+
+// aName must be interned
+bool
+Object::__getattr__(
+    JSContext *aCx, JS::HandleObject self, JS::HandleId aId, PyObject *aName,
+    JS::MutableHandleValue aResult
+)
+{
+    bool result = false;
+    PyObject *aPyResult = nullptr;
+
+    if ((aPyResult = __lookup__(aCx, self, aId, aName, aResult))) { // +1
+        if (aPyResult != Py_None || aResult.isUndefined()) {
             aResult.set(Wrap(aCx, aPyResult));
-            Py_DECREF(aPyResult); // -1
-            result = !aResult.isUndefined();
         }
-        Py_DECREF(aName); // -1
+        Py_DECREF(aPyResult); // -1
+        result = !aResult.isUndefined();
     }
     return result;
 }
 
 
+// returns the attribute, or None with aResult set to the (cached) method
+// function bound to self
+PyObject *
+Object::__lookup__(
+    JSContext *aCx, JS::HandleObject self, JS::HandleId aId, PyObject *aName,
+    JS::MutableHandleValue aResult
+)
+{
+    PyObject *aObject = __unwrap__(self), *aPyResult = nullptr;
+    PyObject **aDictPtr = nullptr;
+    PyTypeObject *aType = Py_TYPE(aObject);
+    Slots *aSlots = nullptr;
+    int kind = Slots::Unknown;
+
+    aResult.setUndefined();
+    if (
+        (aType->tp_getattro != PyObject_GenericGetAttr) ||
+        !(aSlots = TypeSlots.ensure(aType)) ||
+        ((kind = aSlots->GetKind(aName)) == Slots::Attribute) ||
+        (kind == Slots::Unknown)
+    ) {
+        if (!aSlots && PyErr_Occurred()) {
+            return nullptr;
+        }
+        return PyObject_GetAttr(aObject, aName); // +1
+    }
+    // Method or Missing, only the instance dict can shadow the type
+    if ((aDictPtr = _PyObject_GetDictPtr(aObject)) && *aDictPtr) {
+        if ((aPyResult = PyDict_GetItemWithError(*aDictPtr, aName))) { // borrowed
+            Py_INCREF(aPyResult);
+            return aPyResult; // +1
+        }
+        if (PyErr_Occurred()) {
+            return nullptr;
+        }
+    }
+    if (kind == Slots::Missing) {
+        PyErr_Format(
+            PyExc_AttributeError, "'%.50s' object has no attribute '%U'",
+            aType->tp_name, aName
+        );
+        return nullptr;
+    }
+    if (!__method__(aCx, self, aId, aName, aResult)) {
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+
+// one method function per instance and name, bound to the instance so it can
+// be detached (setTimeout(obj.method), arr.map(obj.method)), no Python bound
+// method is created
+bool
+Object::__method__(
+    JSContext *aCx, JS::HandleObject self, JS::HandleId aId, PyObject *aName,
+    JS::MutableHandleValue aResult
+)
+{
+    JS::RootedObject aMethods(aCx), aMethod(aCx);
+
+    {
+        JSAutoCompartment ac(aCx, self);
+
+        aResult.set(JS_GetReservedSlot(self, MethodsSlot));
+        if (aResult.isObject()) {
+            aMethods = &aResult.toObject();
+        }
+        else {
+            aMethods = JS_NewObjectWithGivenProto(aCx, nullptr, nullptr);
+            if (!aMethods) {
+                return false;
+            }
+            JS_SetReservedSlot(self, MethodsSlot, JS::ObjectValue(*aMethods));
+        }
+        if (!JS_GetPropertyById(aCx, aMethods, aId, aResult)) {
+            return false;
+        }
+        if (!aResult.isObject()) {
+            if (
+                !(aMethod = Slots::NewMethod(aCx, aId, aName, self)) ||
+                !JS_DefinePropertyById(
+                    aCx, aMethods, aId, aMethod,
+                    JSPROP_READONLY | JSPROP_PERMANENT
+                )
+            ) {
+                return false;
+            }
+            aResult.setObject(*aMethod);
+        }
+    }
+    return JS_WrapValue(aCx, aResult);
+}
+
+
 bool
 Object::__setattr__(
     JSContext* aCx, JS::HandleObject self, JS::HandleId aId,
@@ -173,6 +417,25 @@ Object::__delattr__(JSContext *aCx, JS::HandleObject self, JS::HandleId aId)
 }
 
 
+// aName must be interned
+bool
+Object::__define__(
+    JSContext *aCx, JS::HandleObject self, JS::HandleId aId, PyObject *aName
+)
+{
+    JS::RootedObject aGetter(aCx, Slots::GetGetter(aCx, aId, aName));
+    JS::RootedObject aSetter(aCx, Slots::GetSetter(aCx, aId, aName));
+    if (!aGetter || !aSetter) {
+        return false;
+    }
+    return JS_DefinePropertyById(
+        aCx, self, aId, JS::UndefinedHandleValue, JSPY_ACCESSOR_FLAGS,
+        JS_DATA_TO_FUNC_PTR(JSNative, aGetter.get()),
+        JS_DATA_TO_FUNC_PTR(JSNative, aSetter.get())
+    );
+}
+
+
 /* -------------------------------------------------------------------------- */
 
 template<typename T>
@@ -201,6 +464,12 @@ Object::Alloc(
     return self;
 }
 
+template
+JSObject *
+Object::Alloc<Object>(
+    JSContext *aCx, const JS::HandleObject &aProto, PyObject *aPyObject
+);
+
 template
 JSObject *
 Object::Alloc<Type>(
@@ -218,19 +487,22 @@ Object::Resolve(
     AutoReporter ar(aCx);
     PyObject *aName = nullptr;
     bool result = false;
+    int status = -1;
 
     if ((aName = pyjs::WrapId(aCx, aId))) { // +1
-        result = true;
-        if (PyObject_HasAttr(__unwrap__(self), aName)) {
+        PyUnicode_InternInPlace(&aName);
+        // don't evaluate the attribute here, GetPropertyOp (or the accessor)
+        // will do it
+        if ((status = _PyObject_HasAttrNoEval(__unwrap__(self), aName)) >= 0) {
+            result = true;
+        }
+        if (status > 0) {
             *resolvedp = true;
-            /*if (
-                !JS_DefinePropertyById(
-                    aCx, self, aId, JS::UndefinedHandleValue,
-                    JSPROP_ENUMERATE | JSPROP_SHARED | JSPROP_RESOLVING
-                )
-            ) {
-                result = false;
-            }*/
+#ifdef PYXUL_JSPY_ACCESSORS
+            if (__accessible__(self)) {
+                result = __define__(aCx, self, aId, aName);
+            }
+#endif
         }
         Py_DECREF(aName); // -1
     }
@@ -241,10 +513,15 @@ Object::Resolve(
 void
 Object::Finalize(js::FreeOp *fop, JSObject *self)
 {
+    AutoGILState ags; // XXX: important
+
     PyObject *aObject = nullptr;
 
     if ((aObject = (PyObject *)JS_GetPrivate(self))) {
         Objects.remove(aObject);
+        if (PyType_Check(aObject)) {
+            TypeSlots.discard((PyTypeObject *)aObject);
+        }
         __finalize__(self);
     }
 }
@@ -291,6 +568,116 @@ Object::Moved(JSObject *self, const JSObject *old)
 }
 
 
+bool
+Object::Getter(JSContext *aCx, unsigned argc, JS::Value *vp)
+{
+    AutoGILState ags; // XXX: important
+
+    AutoResult result = false;
+    AutoReporter ar(aCx);
+    PyObject *aName = nullptr;
+
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedId aId(aCx);
+    JS::RootedObject self(aCx);
+    if (!__accessor__(aCx, args, &aId, &self)) {
+        return false;
+    }
+    aName = Slots::GetName(&args.callee(), Slots::AccessorName); // borrowed
+    if (
+        !(result = __getattr__(aCx, self, aId, aName, args.rval())) &&
+        PyErr_ExceptionMatches(PyExc_AttributeError)
+    ) {
+        JS::RootedObject aProto(aCx);
+        if (JS_GetPrototype(aCx, self, &aProto) && aProto) {
+            result = __forward__(aCx, aProto, aId, args.thisv(), args.rval());
+        }
+    }
+    return bool(result);
+}
+
+
+// the setProperty op handles the wrapper itself, this is for objects
+// inheriting from it
+bool
+Object::Setter(JSContext *aCx, unsigned argc, JS::Value *vp)
+{
+    AutoGILState ags; // XXX: important
+
+    AutoResult result = false;
+    AutoReporter ar(aCx);
+
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedId aId(aCx);
+    JS::RootedObject self(aCx);
+    if (!__accessor__(aCx, args, &aId, &self)) {
+        return false;
+    }
+    if ((result = __setattr__(aCx, self, aId, args.get(0)))) {
+        args.rval().setUndefined();
+    }
+    return bool(result);
+}
+
+
+bool
+Object::Method(JSContext *aCx, unsigned argc, JS::Value *vp)
+{
+    AutoGILState ags; // XXX: important
+
+    AutoResult result = false;
+    AutoReporter ar(aCx);
+    PyObject *aName = nullptr, *aMethod = nullptr, *aArgs = nullptr;
+    PyObject *aCallArgs = nullptr, *aResult = nullptr, *aObject = nullptr;
+    Py_ssize_t size = 0, i;
+
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    // bound, this is ignored
+    JS::RootedObject self(
+        aCx,
+        &js::GetFunctionNativeReserved(
+            &args.callee(), Slots::MethodSelf
+        ).toObject()
+    );
+    aObject = __unwrap__(self); // borrowed
+    aName = Slots::GetName(&args.callee(), Slots::MethodName); // borrowed
+    if ((aArgs = pyjs::WrapArgs(aCx, args))) { // +1
+        // fast path: call the unbound method with self prepended
+        if ((aMethod = Slots::LookupMethod(aObject, aName))) { // +1
+            size = PyTuple_GET_SIZE(aArgs);
+            if ((aCallArgs = PyTuple_New(size + 1))) { // +1
+                Py_INCREF(aObject);
+                PyTuple_SET_ITEM(aCallArgs, 0, aObject);
+                for (i = 0; i < size; i++) {
+                    Py_INCREF(PyTuple_GET_ITEM(aArgs, i));
+                    PyTuple_SET_ITEM(
+                        aCallArgs, i + 1, PyTuple_GET_ITEM(aArgs, i)
+                    );
+                }
+                aResult = PyObject_CallObject(aMethod, aCallArgs); // +1
+                Py_DECREF(aCallArgs); // -1
+            }
+            Py_DECREF(aMethod); // -1
+        }
+        // shadowed or changed since the lookup
+        else if (
+            !PyErr_Occurred() &&
+            (aMethod = PyObject_GetAttr(aObject, aName)) // +1
+        ) {
+            aResult = PyObject_CallObject(aMethod, aArgs); // +1
+            Py_DECREF(aMethod); // -1
+        }
+        if (aResult) {
+            args.rval().set(Wrap(aCx, aResult));
+            Py_DECREF(aResult); // -1
+            result = !args.rval().isUndefined();
+        }
+        Py_DECREF(aArgs); // -1
+    }
+    return bool(result);
+}
+
+
 bool
 Object::GetPropertyOp(
     JSContext* aCx, JS::HandleObject self, JS::HandleValue rec, JS::HandleId aId,
@@ -301,35 +688,12 @@ Object::GetPropertyOp(
 
     AutoResult result = false;
     AutoReporter ar(aCx);
-    PyObject *err_type = nullptr, *err_inst = nullptr, *err_trbk = nullptr;
 
     if (
         !(result = __getattr__(aCx, self, aId, aResult)) &&
         PyErr_ExceptionMatches(PyExc_AttributeError)
     ) {
-        PyErr_Fetch(&err_type, &err_inst, &err_trbk);
-        JS::Rooted<JS::PropertyDescriptor> desc(aCx);
-        if ((result = JS_GetPropertyDescriptorById(aCx, self, aId, &desc))) {
-            JS::RootedObject aObject(aCx, desc.object());
-            if (!aObject) {
-                PyErr_Restore(err_type, err_inst, err_trbk);
-                result = false;
-            }
-            else {
-                Py_XDECREF(err_trbk);
-                Py_XDECREF(err_inst);
-                Py_XDECREF(err_type);
-                result = JS_ForwardGetPropertyTo(
-                    aCx, aObject, aId, rec, aResult
-                );
-            }
-        }
-        else {
-            PyErr_Restore(err_type, err_inst, err_trbk);
-            //Py_XDECREF(err_trbk);
-            //Py_XDECREF(err_inst);
-            //Py_XDECREF(err_type);
-        }
+        result = __forward__(aCx, self, aId, rec, aResult);
     }
     return bool(result);
 }
@@ -378,16 +742,33 @@ Object::Enumerate(
 {
     AutoGILState ags; // XXX: important
 
+    _Py_IDENTIFIER(__dict__);
     AutoResult result = false;
     AutoReporter ar(aCx);
-    PyObject *aVars = nullptr, *aNames = nullptr;
+    PyObject *aObject = __unwrap__(self), **aDictPtr = nullptr;
+    PyObject *aDict = nullptr, *aNames = nullptr;
 
-    if ((aVars = _PyObject_Vars(__unwrap__(self)))) { // +1
-        if ((aNames = PyDict_Keys(aVars))) { // +1
-            result = __merge__(aCx, aIds, aNames);
+    if ((aDictPtr = _PyObject_GetDictPtr(aObject))) {
+        result = (!*aDictPtr || __dict2ids__(aCx, aIds, *aDictPtr));
+    }
+    else if (_PyObject_LookupAttrId(aObject, &PyId___dict__, &aDict) >= 0) { // +1
+        if (!aDict) {
+            result = true;
+        }
+        else if (PyDict_Check(aDict)) {
+            result = __dict2ids__(aCx, aIds, aDict);
+        }
+        else if ((aNames = PyDict_New())) { // +1
+            result = (
+                !PyDict_Update(aNames, aDict) &&
+                __dict2ids__(aCx, aIds, aNames)
+            );
             Py_DECREF(aNames); // -1
         }
-        Py_DECREF(aVars); // -1
+        Py_XDECREF(aDict); // -1
+    }
+    if (result) {
+        result = __slots2ids__(aCx, aIds, aObject);
     }
     return bool(result);
 }
@@ -423,6 +804,10 @@ const js::Class Object::Class = {
 ObjectCache Object::Objects;
 
 
+// Object::TypeSlots
+SlotCache Object::TypeSlots;
+
+
 JSObject *
 Object::New(JSContext* aCx, PyObject *aObject)
 {
@@ -565,7 +950,7 @@ Object::Sequence::DeletePropertyOp(
 
 // Object::Sequence::ObjectOps
 const js::ObjectOps Object::Sequence::ObjectOps = {
-    JSPY_OBJECT_OBJECT_OPS
+    JSPY_SEQUENCE_OBJECT_OPS
 };
 
 
@@ -0,0 +1,307 @@
+/*
+# Python for XUL
+# copyright © 2021 Malek Hadj-Ali
+#
+# This program is free software: you can redistribute it and/or modify it
+# under the terms of the GNU General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "wrappers/api.h"
+#include "wrappers/internals.h"
+
+
+namespace pyxul::wrappers::jspy {
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::jspy::Prefetcher
+   -------------------------------------------------------------------------- */
+
+// pulls up to mCount items into a new buffer, an error after the first item
+// is kept for the next batch
+bool
+Prefetcher::__fill__(JSContext *aCx, JS::HandleObject self)
+{
+    AutoGILState ags; // XXX: important
+
+    AutoResult result = false;
+    AutoReporter ar(aCx);
+    Prefetcher *aPrefetcher = (Prefetcher *)JS_GetPrivate(self);
+    PyObject *aItem = nullptr;
+    JS::RootedValue value(aCx);
+    bool done = false;
+
+    JS::AutoValueVector aValues(aCx);
+    if (aPrefetcher->mErrType) {
+        PyErr_Restore(
+            aPrefetcher->mErrType, aPrefetcher->mErrValue, aPrefetcher->mErrTraceback
+        );
+        aPrefetcher->mErrType = nullptr;
+        aPrefetcher->mErrValue = nullptr;
+        aPrefetcher->mErrTraceback = nullptr;
+        return bool(result);
+    }
+    if (!aValues.reserve(aPrefetcher->mCount)) {
+        PyErr_NoMemory();
+        return bool(result);
+    }
+    while (aPrefetcher->mIter && (aValues.length() < aPrefetcher->mCount)) {
+        if (!(aItem = PyIter_Next(aPrefetcher->mIter))) { // +1
+            done = !PyErr_Occurred();
+            break;
+        }
+        value.set(Wrap(aCx, aItem));
+        Py_DECREF(aItem); // -1
+        if (value.isUndefined()) {
+            break;
+        }
+        aValues.infallibleAppend(value);
+    }
+    if (PyErr_Occurred()) {
+        if (aValues.empty()) {
+            return bool(result);
+        }
+        PyErr_Fetch(
+            &aPrefetcher->mErrType, &aPrefetcher->mErrValue,
+            &aPrefetcher->mErrTraceback
+        );
+    }
+    if (done) {
+        Py_CLEAR(aPrefetcher->mIter);
+    }
+    JS::RootedObject aBuffer(aCx, JS_NewArrayObject(aCx, aValues));
+    if (aBuffer) {
+        JS_SetReservedSlot(self, BufferSlot, JS::ObjectValue(*aBuffer));
+        JS_SetReservedSlot(self, IndexSlot, JS::Int32Value(0));
+        JS_SetReservedSlot(self, LengthSlot, JS::Int32Value(aValues.length()));
+        JS_SetReservedSlot(
+            self, DoneSlot,
+            JS::BooleanValue(!aPrefetcher->mIter && !aPrefetcher->mErrType)
+        );
+        result = true;
+    }
+    return bool(result);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Prefetcher::Type.tp_dealloc
+void
+Prefetcher::Dealloc(Prefetcher *self)
+{
+    PyObject_GC_UnTrack(self);
+    Py_XDECREF(self->mIter);
+    Py_XDECREF(self->mErrType);
+    Py_XDECREF(self->mErrValue);
+    Py_XDECREF(self->mErrTraceback);
+    PyObject_GC_Del(self);
+}
+
+
+// Prefetcher::Type.tp_traverse
+int
+Prefetcher::Traverse(Prefetcher *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->mIter);
+    Py_VISIT(self->mErrType);
+    Py_VISIT(self->mErrValue);
+    Py_VISIT(self->mErrTraceback);
+    return 0;
+}
+
+
+// Prefetcher::Type.tp_iternext
+PyObject *
+Prefetcher::Next(Prefetcher *self)
+{
+    if (self->mErrType) {
+        PyErr_Restore(self->mErrType, self->mErrValue, self->mErrTraceback);
+        self->mErrType = nullptr;
+        self->mErrValue = nullptr;
+        self->mErrTraceback = nullptr;
+        return nullptr;
+    }
+    if (!self->mIter) {
+        return nullptr;
+    }
+    return PyIter_Next(self->mIter);
+}
+
+
+// Prefetcher::Type
+PyTypeObject Prefetcher::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul.prefetch",
+    .tp_basicsize = sizeof(Prefetcher),
+    .tp_dealloc = (destructor)Prefetcher::Dealloc,
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC),
+    .tp_traverse = (traverseproc)Prefetcher::Traverse,
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)Prefetcher::Next,
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+// Prefetcher::ClassOps.finalize
+void
+Prefetcher::Finalize(js::FreeOp *fop, JSObject *self)
+{
+    AutoGILState ags; // XXX: important
+
+    PyObject *aObject = nullptr;
+
+    if ((aObject = (PyObject *)JS_GetPrivate(self))) {
+        Py_DECREF(aObject);
+        JS_SetPrivate(self, nullptr);
+    }
+}
+
+
+// Prefetcher::GetIterator
+bool
+Prefetcher::GetIterator(JSContext *aCx, unsigned argc, JS::Value *vp)
+{
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    args.rval().set(args.thisv());
+    return true;
+}
+
+
+// Prefetcher::__next__, only takes the GIL when the buffer is drained
+bool
+Prefetcher::__next__(JSContext *aCx, unsigned argc, JS::Value *vp)
+{
+    int32_t index = 0, length = 0;
+
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject self(aCx, JS::ToObject(aCx, args.thisv()));
+    if (!self || !JS_InstanceOf(aCx, self, js::Jsvalify(&Class), &args)) {
+        return false;
+    }
+    index = JS_GetReservedSlot(self, IndexSlot).toInt32();
+    length = JS_GetReservedSlot(self, LengthSlot).toInt32();
+    if ((index >= length) && !JS_GetReservedSlot(self, DoneSlot).toBoolean()) {
+        if (!__fill__(aCx, self)) {
+            return false;
+        }
+        index = 0;
+        length = JS_GetReservedSlot(self, LengthSlot).toInt32();
+    }
+    JS::RootedValue value(aCx, JS::UndefinedValue());
+    JS::RootedValue done(aCx, JS::TrueValue());
+    if (index < length) {
+        JS::RootedObject aBuffer(
+            aCx, &JS_GetReservedSlot(self, BufferSlot).toObject()
+        );
+        if (
+            !JS_GetElement(aCx, aBuffer, index, &value) ||
+            !JS_SetElement(aCx, aBuffer, index, JS::UndefinedHandleValue)
+        ) {
+            return false;
+        }
+        JS_SetReservedSlot(self, IndexSlot, JS::Int32Value(index + 1));
+        done.setBoolean(false);
+    }
+    JS::RootedObject aResult(aCx, JS_NewPlainObject(aCx));
+    if (
+        aResult &&
+        JS_DefineProperty(aCx, aResult, "value", value, JSPROP_ENUMERATE) &&
+        JS_DefineProperty(aCx, aResult, "done", done, JSPROP_ENUMERATE)
+    ) {
+        args.rval().setObject(*aResult);
+        return true;
+    }
+    return false;
+}
+
+
+// Prefetcher::ClassOps
+const js::ClassOps Prefetcher::ClassOps = {
+    .finalize = Finalize,
+};
+
+
+/* public ------------------------------------------------------------------- */
+
+// Prefetcher::Class
+const js::Class Prefetcher::Class = {
+    .name = "pyxul::wrappers::jspy::Prefetcher",
+    .flags = (
+        JSCLASS_HAS_PRIVATE | JSCLASS_FOREGROUND_FINALIZE |
+        JSCLASS_HAS_RESERVED_SLOTS(ReservedSlots)
+    ),
+    .cOps = &ClassOps,
+};
+
+
+// Prefetcher::Functions
+const JSFunctionSpec Prefetcher::Functions[] = {
+    JS_SYM_FN(iterator, Prefetcher::GetIterator, 0, 0),
+    JS_FN("next", Prefetcher::__next__, 0, 0),
+    JS_FS_END
+};
+
+
+// Prefetcher::Proto
+JS::PersistentRootedObject Prefetcher::Proto;
+
+
+PyObject *
+Prefetcher::New(PyObject *aIterable, Py_ssize_t aCount)
+{
+    Prefetcher *self = nullptr;
+    PyObject *aIter = nullptr;
+
+    PY_ENSURE_TRUE(
+        ((aCount > 0) && (aCount <= INT32_MAX)), nullptr,
+        PyExc_ValueError, "prefetch count must be between 1 and %d", INT32_MAX
+    );
+    if (!(aIter = PyObject_GetIter(aIterable))) { // +1
+        return nullptr;
+    }
+    if (!(self = PyObject_GC_New(Prefetcher, &Prefetcher::Type))) {
+        Py_DECREF(aIter); // -1
+        return nullptr;
+    }
+    self->mIter = aIter; // steals the reference
+    self->mCount = aCount;
+    self->mErrType = nullptr;
+    self->mErrValue = nullptr;
+    self->mErrTraceback = nullptr;
+    PyObject_GC_Track(self);
+    return self;
+}
+
+
+// not cached, each wrapper buffers on its own
+JSObject *
+Prefetcher::Alloc(JSContext *aCx, PyObject *aObject)
+{
+    JSAutoCompartment ac(aCx, Proto);
+    JS::RootedObject self(
+        aCx, JS_NewObjectWithGivenProto(aCx, js::Jsvalify(&Class), Proto)
+    );
+    if (self) {
+        Py_INCREF(aObject);
+        JS_SetPrivate(self, aObject);
+        JS_SetReservedSlot(self, IndexSlot, JS::Int32Value(0));
+        JS_SetReservedSlot(self, LengthSlot, JS::Int32Value(0));
+        JS_SetReservedSlot(self, DoneSlot, JS::FalseValue());
+    }
+    return self;
+}
+
+
+} // namespace pyxul::wrappers::jspy
@@ -0,0 +1,320 @@
+/*
+# Python for XUL
+# copyright © 2021 Malek Hadj-Ali
+#
+# This program is free software: you can redistribute it and/or modify it
+# under the terms of the GNU General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "wrappers/api.h"
+#include "wrappers/internals.h"
+
+
+namespace pyxul::wrappers::jspy {
+
+
+namespace { // anonymous
+
+
+// the accessors of a name in a compartment, weak: they live as long as some
+// object has them defined
+class Accessors final {
+    public:
+        Accessors() : mGetter(nullptr), mSetter(nullptr) {
+        }
+
+        JS::Heap<JSObject *> mGetter;
+        JS::Heap<JSObject *> mSetter;
+};
+
+
+typedef nsClassHashtable<nsPtrHashKey<PyObject>, Accessors> AccessorTable;
+
+
+// out of reach of scripts, by compartment then by (interned) name
+static nsClassHashtable<nsPtrHashKey<JSCompartment>, AccessorTable> sAccessors;
+
+
+// drop the accessors that were collected, called on each GC
+static void
+__sweep__(JSContext *aCx, void *data)
+{
+    AccessorTable *aTable = nullptr;
+    Accessors *aAccessors = nullptr;
+
+    for (auto iter = sAccessors.Iter(); !iter.Done(); iter.Next()) {
+        aTable = iter.UserData();
+        for (auto entry = aTable->Iter(); !entry.Done(); entry.Next()) {
+            aAccessors = entry.UserData();
+            JS_UpdateWeakPointerAfterGC(&aAccessors->mGetter);
+            JS_UpdateWeakPointerAfterGC(&aAccessors->mSetter);
+            if (!aAccessors->mGetter.get() && !aAccessors->mSetter.get()) {
+                entry.Remove();
+            }
+        }
+        if (!aTable->Count()) {
+            iter.Remove();
+        }
+    }
+}
+
+
+// the name of a function lives in a reserved slot, held by one of these so
+// it is released with the function
+static void
+__finalize_name__(js::FreeOp *fop, JSObject *self)
+{
+    AutoGILState ags; // XXX: important
+
+    PyObject *aName = nullptr;
+
+    if ((aName = (PyObject *)JS_GetPrivate(self))) {
+        Py_DECREF(aName);
+    }
+}
+
+
+static const js::ClassOps sNameClassOps = {
+    .finalize = __finalize_name__,
+};
+
+
+static const js::Class sNameClass = {
+    .name = "pyxul::wrappers::jspy::Slots::Name",
+    .flags = (JSCLASS_HAS_PRIVATE | JSCLASS_FOREGROUND_FINALIZE),
+    .cOps = &sNameClassOps,
+};
+
+
+static bool
+__name__(JSContext *aCx, PyObject *aName, JS::MutableHandleValue aResult)
+{
+    JSObject *aHolder = nullptr;
+
+    if (!(aHolder = JS_NewObject(aCx, js::Jsvalify(&sNameClass)))) {
+        return false;
+    }
+    Py_INCREF(aName);
+    JS_SetPrivate(aHolder, aName);
+    aResult.setObject(*aHolder);
+    return true;
+}
+
+
+} // namespace anonymous
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::jspy::Slots::Slot
+   -------------------------------------------------------------------------- */
+
+class Slots::Slot final {
+    public:
+        Slot() : mKind(Unknown) {
+        }
+
+        int mKind;
+};
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::jspy::Slots
+   -------------------------------------------------------------------------- */
+
+JSObject *
+Slots::__function__(
+    JSContext *aCx, JS::HandleId aId, JSNative aNative,
+    JS::HandleValue aFirst, JS::HandleValue aSecond
+)
+{
+    JSFunction *aFunction = nullptr;
+
+    if (JSID_IS_STRING(aId)) {
+        aFunction = js::NewFunctionByIdWithReserved(aCx, aNative, 0, 0, aId);
+    }
+    else {
+        aFunction = js::NewFunctionWithReserved(aCx, aNative, 0, 0, nullptr);
+    }
+    if (!aFunction) {
+        return nullptr;
+    }
+    JS::RootedObject aResult(aCx, JS_GetFunctionObject(aFunction));
+    js::SetFunctionNativeReserved(aResult, 0, aFirst);
+    js::SetFunctionNativeReserved(aResult, 1, aSecond);
+    return aResult;
+}
+
+
+// the accessors don't depend on the type, they are cached per compartment
+// (and name) for as long as they are in use
+JSObject *
+Slots::__cached__(
+    JSContext *aCx, JS::HandleId aId, PyObject *aName, JSNative aNative
+)
+{
+    JSCompartment *aCompartment = js::GetContextCompartment(aCx);
+    AccessorTable *aTable = nullptr;
+    Accessors *aAccessors = nullptr;
+
+    if (!(aTable = sAccessors.Get(aCompartment))) {
+        aTable = new AccessorTable(8);
+        sAccessors.Put(aCompartment, aTable);
+    }
+    if (!(aAccessors = aTable->Get(aName))) {
+        aAccessors = new Accessors();
+        aTable->Put(aName, aAccessors);
+    }
+    JS::Heap<JSObject *> &aCache = (aNative == Object::Getter) ?
+        aAccessors->mGetter : aAccessors->mSetter;
+    if (aCache.get()) {
+        JS::ExposeObjectToActiveJS(aCache.get());
+        return aCache.get();
+    }
+    // the accessor finds its property through its reserved slots
+    JS::RootedValue aJSId(aCx), aJSName(aCx);
+    if (!JS_IdToValue(aCx, aId, &aJSId) || !__name__(aCx, aName, &aJSName)) {
+        return nullptr;
+    }
+    JS::RootedObject aResult(
+        aCx, __function__(aCx, aId, aNative, aJSId, aJSName)
+    );
+    if (aResult) {
+        aCache = aResult.get();
+    }
+    return aResult;
+}
+
+
+// aName must be interned, a new function calling aName on self, whatever this
+// is when it is called
+JSObject *
+Slots::NewMethod(
+    JSContext *aCx, JS::HandleId aId, PyObject *aName, JS::HandleObject self
+)
+{
+    JS::RootedValue aJSName(aCx);
+    if (!__name__(aCx, aName, &aJSName)) {
+        return nullptr;
+    }
+    JS::RootedValue aSelf(aCx, JS::ObjectValue(*self));
+    return __function__(aCx, aId, Object::Method, aJSName, aSelf);
+}
+
+
+// the unbound method aObject.aName if it isn't shadowed by the instance dict,
+// nullptr (without an exception set) if there is none
+PyObject *
+Slots::LookupMethod(PyObject *aObject, PyObject *aName)
+{
+    PyTypeObject *aType = Py_TYPE(aObject);
+    PyObject *aDescr = nullptr, **aDictPtr = nullptr;
+
+    if (
+        (aType->tp_getattro == PyObject_GenericGetAttr) &&
+        (aDescr = _PyType_Lookup(aType, aName)) && // borrowed
+        (PyFunction_Check(aDescr) || Py_IS_TYPE(aDescr, &PyMethodDescr_Type))
+    ) {
+        if (
+            (aDictPtr = _PyObject_GetDictPtr(aObject)) && *aDictPtr &&
+            PyDict_GetItemWithError(*aDictPtr, aName) // borrowed
+        ) {
+            return nullptr;
+        }
+        if (PyErr_Occurred()) {
+            return nullptr;
+        }
+        Py_INCREF(aDescr);
+        return aDescr;
+    }
+    return nullptr;
+}
+
+
+// the (borrowed) name held in the reserved slot aSlot of aFunction
+PyObject *
+Slots::GetName(JSObject *aFunction, size_t aSlot)
+{
+    return (PyObject *)JS_GetPrivate(
+        &js::GetFunctionNativeReserved(aFunction, aSlot).toObject()
+    );
+}
+
+
+bool
+Slots::Initialize(JSContext *aCx)
+{
+    PY_ENSURE_TRUE(
+        JS_AddWeakPointerZoneGroupCallback(aCx, __sweep__, nullptr), false,
+        errors::JSError, "Failed to add weak pointer callback"
+    );
+    return true;
+}
+
+
+void
+Slots::Finalize()
+{
+    AutoJSContext aCx;
+
+    JS_RemoveWeakPointerZoneGroupCallback(aCx, __sweep__);
+    sAccessors.Clear();
+}
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::jspy::SlotCache
+   -------------------------------------------------------------------------- */
+
+Slots *
+SlotCache::ensure(PyTypeObject *aType)
+{
+    Slots *aSlots = nullptr;
+
+    if (!(aSlots = get(aType))) {
+        if (!(aSlots = new (std::nothrow) Slots())) {
+            PyErr_NoMemory();
+        }
+        else if (!aSlots->Init(aType)) {
+            delete aSlots;
+            aSlots = nullptr;
+        }
+        else {
+            put(aType, aSlots);
+        }
+    }
+    return aSlots;
+}
+
+
+void
+SlotCache::discard(PyTypeObject *aType)
+{
+    Slots *aSlots = nullptr;
+
+    if ((aSlots = get(aType))) {
+        remove(aType);
+        delete aSlots;
+    }
+}
+
+
+void
+SlotCache::finalizeObject(PyTypeObject *aKey, Slots *aData)
+{
+    if (aData) {
+        delete aData;
+    }
+}
+
+
+} // namespace pyxul::wrappers::jspy
@@ -0,0 +1,437 @@
+/*
+# Python for XUL
+# copyright © 2021 Malek Hadj-Ali
+#
+# This program is free software: you can redistribute it and/or modify it
+# under the terms of the GNU General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "wrappers/api.h"
+#include "wrappers/internals.h"
+
+#include "nsThreadUtils.h"
+
+
+namespace pyxul::wrappers::jspy {
+
+
+namespace { // anonymous
+
+
+// a promise is created with a no-op executor, settled by Task
+static bool
+__executor__(JSContext *aCx, unsigned argc, JS::Value *vp)
+{
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    args.rval().setUndefined();
+    return true;
+}
+
+
+// {value: aValue, done: aDone}
+static bool
+__result__(
+    JSContext *aCx, JS::HandleValue aValue, bool aDone,
+    JS::MutableHandleValue aResult
+)
+{
+    JS::RootedValue done(aCx, JS::BooleanValue(aDone));
+    JS::RootedObject aObject(aCx, JS_NewPlainObject(aCx));
+    if (
+        aObject &&
+        JS_DefineProperty(aCx, aObject, "value", aValue, JSPROP_ENUMERATE) &&
+        JS_DefineProperty(aCx, aObject, "done", done, JSPROP_ENUMERATE)
+    ) {
+        aResult.setObject(*aObject);
+        return true;
+    }
+    return false;
+}
+
+
+// the promise of a wrapped coroutine or future, for as long as it lives
+class Promised final {
+    public:
+        Promised(JSContext *aCx, JS::HandleObject aPromise, PyObject *aWeakRef)
+            : mPromise(aCx, aPromise), mWeakRef(aWeakRef) {
+        }
+
+        ~Promised() {
+            mPromise.reset();
+            Py_XDECREF(mWeakRef);
+        }
+
+        JS::PersistentRootedObject mPromise;
+        PyObject *mWeakRef;
+};
+
+
+static nsClassHashtable<nsPtrHashKey<PyObject>, Promised> sPromises(32);
+
+
+// weakref callback, self is the address of the dead awaitable. Off the main
+// thread the entry can't be released, Task::Get() replaces it if the address
+// is reused
+static PyObject *
+__forget__(PyObject *self, PyObject *aWeakRef)
+{
+    PyObject *aKey = (PyObject *)PyLong_AsVoidPtr(self);
+    Promised *aEntry = nullptr;
+
+    if (!aKey && PyErr_Occurred()) {
+        return nullptr;
+    }
+    if (
+        NS_IsMainThread() && (aEntry = sPromises.Get(aKey)) &&
+        (aEntry->mWeakRef == aWeakRef)
+    ) {
+        sPromises.Remove(aKey);
+    }
+    Py_RETURN_NONE;
+}
+
+
+static PyMethodDef __forget_def__ = {
+    "__forget__", (PyCFunction)__forget__, METH_O, nullptr
+};
+
+
+// with a running asyncio loop, coroutines run as asyncio tasks (so that
+// asyncio.current_task() works), the Task then waits on them
+static PyObject *
+__ensure__(PyObject *aAwaitable)
+{
+    _Py_IDENTIFIER(_get_running_loop);
+    _Py_IDENTIFIER(ensure_future);
+    PyObject *aAsyncio = nullptr, *aLoop = nullptr, *aResult = nullptr;
+
+    if (!PyCoro_CheckExact(aAwaitable)) {
+        Py_INCREF(aAwaitable);
+        return aAwaitable;
+    }
+    if (!(aAsyncio = PyImport_ImportModule("asyncio"))) { // +1
+        return nullptr;
+    }
+    aLoop = _PyObject_CallMethodIdNoArgs(aAsyncio, &PyId__get_running_loop); // +1
+    if (aLoop == Py_None) {
+        Py_INCREF(aAwaitable);
+        aResult = aAwaitable;
+    }
+    else if (aLoop) {
+        aResult = _PyObject_CallMethodIdOneArg(
+            aAsyncio, &PyId_ensure_future, aAwaitable
+        ); // +1
+    }
+    Py_XDECREF(aLoop); // -1
+    Py_DECREF(aAsyncio); // -1
+    return aResult;
+}
+
+
+} // namespace anonymous
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::jspy::Task
+   -------------------------------------------------------------------------- */
+
+// resolve with aValue (nullptr: the async iterator is exhausted)
+bool
+Task::__resolve__(JSContext *aCx, Task *self, PyObject *aValue)
+{
+    JS::RootedValue value(aCx, JS::UndefinedValue());
+    JS::RootedValue aResult(aCx);
+
+    if (aValue && (self->mKind != Return)) {
+        value.set(Wrap(aCx, aValue));
+        if (value.isUndefined()) {
+            return false;
+        }
+    }
+    if (self->mKind == Result) {
+        aResult.set(value);
+    }
+    else if (!__result__(aCx, value, (!aValue || self->mKind == Return), &aResult)) {
+        return false;
+    }
+    JS::RootedObject aPromise(aCx, *self->mPromise);
+    if (!JS::ResolvePromise(aCx, aPromise, aResult)) {
+        return false;
+    }
+    __done__(self);
+    return true;
+}
+
+
+// reject with the pending Python (or JS) exception
+bool
+Task::__reject__(JSContext *aCx, Task *self)
+{
+    JS::RootedValue aReason(aCx, JS::UndefinedValue());
+
+    if (PyErr_Occurred()) {
+        xpc::ReportError(); // sets the JS exception
+    }
+    if (JS_IsExceptionPending(aCx)) {
+        if (!JS_GetPendingException(aCx, &aReason)) {
+            return false;
+        }
+        JS_ClearPendingException(aCx);
+    }
+    JS::RootedObject aPromise(aCx, *self->mPromise);
+    if (!JS::RejectPromise(aCx, aPromise, aReason)) {
+        return false;
+    }
+    __done__(self);
+    return true;
+}
+
+
+void
+Task::__done__(Task *self)
+{
+    delete self->mPromise;
+    self->mPromise = nullptr;
+    Py_CLEAR(self->mIter);
+}
+
+
+// park self on what the awaitable yielded
+bool
+Task::__wait__(JSContext *aCx, Task *self, PyObject *aYielded)
+{
+    _Py_IDENTIFIER(add_done_callback);
+    _Py_IDENTIFIER(_asyncio_future_blocking);
+    PyObject *aAwaitable = nullptr, *aResult = nullptr;
+    int status = -1;
+
+    if (PyObject_TypeCheck(aYielded, &pyjs::Object::Awaitable::Type)) {
+        return !pyjs::Object::Awaitable::Wait(aYielded, self);
+    }
+    if (aYielded == Py_None) { // bare yield, resume on the next microtask
+        JS::RootedValue aUndefined(aCx, JS::UndefinedValue());
+        aAwaitable = pyjs::Object::Awaitable::New(
+            aCx, aUndefined, pyjs::Object::Awaitable::Value
+        ); // +1
+        if (aAwaitable) {
+            status = pyjs::Object::Awaitable::Wait(aAwaitable, self);
+            Py_DECREF(aAwaitable); // -1
+        }
+        return !status;
+    }
+    // an asyncio compatible future
+    if (
+        (status = _PyObject_LookupAttrId(
+            aYielded, &PyId__asyncio_future_blocking, &aResult
+        )) > 0 // +1
+    ) {
+        Py_DECREF(aResult); // -1
+        if (
+            _PyObject_SetAttrId(
+                aYielded, &PyId__asyncio_future_blocking, Py_False
+            ) ||
+            !(aResult = _PyObject_CallMethodIdOneArg(
+                aYielded, &PyId_add_done_callback, self
+            )) // +1
+        ) {
+            return false;
+        }
+        Py_DECREF(aResult); // -1
+        return true;
+    }
+    if (!status) {
+        PyErr_Format(PyExc_RuntimeError, "Task got bad yield: %R", aYielded);
+    }
+    return false;
+}
+
+
+// run the awaitable until it yields, returns or raises
+void
+Task::__step__(JSContext *aCx, Task *self)
+{
+    PyObject *aYielded = nullptr, *aValue = nullptr;
+
+    if (!self->mPromise) { // already settled
+        return;
+    }
+    JSAutoCompartment ac(aCx, *self->mPromise);
+    AutoReporter ar(aCx);
+    // coroutines can't be iterated, only sent to
+    if (PyGen_CheckExact(self->mIter) || PyCoro_CheckExact(self->mIter)) {
+        aYielded = _PyGen_Send((PyGenObject *)self->mIter, Py_None); // +1
+    }
+    else {
+        aYielded = Py_TYPE(self->mIter)->tp_iternext(self->mIter); // +1
+    }
+    if (aYielded) {
+        if (!__wait__(aCx, self, aYielded)) {
+            __reject__(aCx, self);
+        }
+        Py_DECREF(aYielded); // -1
+    }
+    else if (
+        (self->mKind == Next) &&
+        PyErr_ExceptionMatches(PyExc_StopAsyncIteration)
+    ) {
+        PyErr_Clear();
+        if (!__resolve__(aCx, self, nullptr)) {
+            __reject__(aCx, self);
+        }
+    }
+    else if (!_PyGen_FetchStopIterationValue(&aValue)) { // +1
+        if (!__resolve__(aCx, self, aValue)) {
+            __reject__(aCx, self);
+        }
+        Py_DECREF(aValue); // -1
+    }
+    else {
+        __reject__(aCx, self);
+    }
+    if (PyErr_Occurred()) { // the promise itself failed us
+        PyErr_WriteUnraisable((PyObject *)self);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Task::Type.tp_dealloc
+void
+Task::Dealloc(Task *self)
+{
+    PyObject_GC_UnTrack(self);
+    delete self->mPromise;
+    Py_XDECREF(self->mIter);
+    PyObject_GC_Del(self);
+}
+
+
+// Task::Type.tp_traverse
+int
+Task::Traverse(Task *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->mIter);
+    return 0;
+}
+
+
+// Task::Type.tp_call, the wake up callback, arguments are ignored
+PyObject *
+Task::Call(Task *self, PyObject *args, PyObject *kwargs)
+{
+    AutoJSContext aCx;
+
+    Py_INCREF(self); // we may be released by our waiter
+    __step__(aCx, self);
+    Py_DECREF(self);
+    Py_RETURN_NONE;
+}
+
+
+// Task::Type
+PyTypeObject Task::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul::wrappers::jspy::Task",
+    .tp_basicsize = sizeof(Task),
+    .tp_dealloc = (destructor)Task::Dealloc,
+    .tp_call = (ternaryfunc)Task::Call,
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC),
+    .tp_traverse = (traverseproc)Task::Traverse,
+};
+
+
+/* public ------------------------------------------------------------------- */
+
+// a promise (in the current compartment) settled by running aAwaitable,
+// the first step is taken right away
+JSObject *
+Task::New(JSContext *aCx, PyObject *aAwaitable, int aKind)
+{
+    Task *self = nullptr;
+    PyObject *aIter = nullptr;
+    JSFunction *aFunction = nullptr;
+
+    if (!(aIter = _PyCoro_GetAwaitableIter(aAwaitable))) { // +1
+        return nullptr;
+    }
+    if (!(aFunction = JS_NewFunction(aCx, __executor__, 2, 0, nullptr))) {
+        Py_DECREF(aIter); // -1
+        return nullptr;
+    }
+    JS::RootedObject aExecutor(aCx, JS_GetFunctionObject(aFunction));
+    JS::RootedObject aPromise(aCx, JS::NewPromiseObject(aCx, aExecutor));
+    if (!aPromise || !(self = PyObject_GC_New(Task, &Task::Type))) {
+        Py_DECREF(aIter); // -1
+        return nullptr;
+    }
+    self->mIter = aIter; // steals the reference
+    self->mPromise = new JS::PersistentRootedObject(aCx, aPromise);
+    self->mKind = aKind;
+    PyObject_GC_Track(self);
+    __step__(aCx, self);
+    Py_DECREF(self); // waiters hold their own reference
+    return aPromise;
+}
+
+
+// the promise of a coroutine or an asyncio future, one per object (as long as
+// it can be weakly referenced) so reading it twice doesn't await it twice
+JSObject *
+Task::Get(JSContext *aCx, PyObject *aAwaitable)
+{
+    PyObject *aKey = nullptr, *aCallback = nullptr, *aWeakRef = nullptr;
+    PyObject *aAwaited = nullptr;
+    Promised *aEntry = nullptr;
+
+    JS::RootedObject aPromise(aCx);
+    if ((aEntry = sPromises.Get(aAwaitable))) {
+        if (PyWeakref_GET_OBJECT(aEntry->mWeakRef) == aAwaitable) {
+            aPromise = aEntry->mPromise;
+            return JS_WrapObject(aCx, &aPromise) ? aPromise.get() : nullptr;
+        }
+        sPromises.Remove(aAwaitable); // a dead one, at the same address
+    }
+    if (PyType_SUPPORTS_WEAKREFS(Py_TYPE(aAwaitable))) {
+        if ((aKey = PyLong_FromVoidPtr(aAwaitable))) { // +1
+            if ((aCallback = PyCFunction_New(&__forget_def__, aKey))) { // +1
+                aWeakRef = PyWeakref_NewRef(aAwaitable, aCallback); // +1
+                Py_DECREF(aCallback); // -1
+            }
+            Py_DECREF(aKey); // -1
+        }
+        if (!aWeakRef) {
+            return nullptr;
+        }
+    }
+    if ((aAwaited = __ensure__(aAwaitable))) { // +1
+        aPromise = New(aCx, aAwaited, Result);
+        Py_DECREF(aAwaited); // -1
+    }
+    if (!aPromise || !aWeakRef) {
+        Py_XDECREF(aWeakRef); // -1
+        return aPromise;
+    }
+    sPromises.Put(aAwaitable, new Promised(aCx, aPromise, aWeakRef));
+    return aPromise;
+}
+
+
+void
+Task::Finalize()
+{
+    sPromises.Clear();
+}
+
+
+} // namespace pyxul::wrappers::jspy
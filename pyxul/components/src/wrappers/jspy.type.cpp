@@ -70,18 +70,11 @@ Type::__iter__(PyObject *aObject, int type)
     PyObject *result = nullptr, *dict = nullptr;
 
     if (type) {
-        if ((dict = _PyObject_Dir(aObject))) { // +1
-            switch (type) {
-                case IterType::Keys:
-                    result = PyDict_Keys(dict); // +1
-                    break;
-                case IterType::Values:
-                    result = PyDict_Values(dict); // +1
-                    break;
-                default:
-                    PyErr_BadArgument();
-                    break;
-            }
+        if ((type != IterType::Keys) && (type != IterType::Values)) {
+            PyErr_BadArgument();
+        }
+        else if ((dict = _PyObject_Dir(aObject))) { // +1
+            result = Walker::New(dict, type); // +1
             Py_DECREF(dict); // -1
         }
     }
@@ -102,20 +95,10 @@ Type::__iterator__(
     PyObject *aIter = nullptr;
 
     if ((aIter = PyObject_GetIter(aObject))) { // +1
-        JS::RootedObject aJSIter(aCx, Object::__new__(aCx, aIter)); // no caching
-        if (aJSIter) {
-            JS::RootedObject aProto(aCx);
-            JS::RootedValue aNext(aCx);
-            result = (
-                JS_GetPrototype(aCx, aJSIter, &aProto) &&
-                JS_GetProperty(
-                    aCx, aProto, (legacy) ? "__legacy__" : "__next__", &aNext
-                ) &&
-                JS_SetProperty(aCx, aProto, "next", aNext)
-            );
-            if (result) {
-                args.rval().setObject(*aJSIter);
-            }
+        JS::RootedObject aJSIter(aCx, Iterator::New(aCx, aIter, legacy));
+        if (aJSIter && JS_WrapObject(aCx, &aJSIter)) {
+            args.rval().setObject(*aJSIter);
+            result = true;
         }
         Py_DECREF(aIter); // -1
     }
@@ -123,45 +106,119 @@ Type::__iterator__(
 }
 
 
+// streams (key, value) entries from any iterable
 bool
 Type::__map__(JSContext *aCx, JS::CallArgs &args, PyObject *aObject)
 {
-    PyObject *items = nullptr, *item = nullptr;
-    Py_ssize_t size = 0, i = 0;
-
-    if ((items = PySequence_Fast(aObject, "expected a sequence"))) { // +1
-        if ((size = PySequence_Fast_GET_SIZE(items)) > 0) {
-            // |function| is args[0]
-            JS::RootedValue aFun(aCx, args[0]);
-            // |this| is args[1] if provided
-            JS::RootedValue aThis(
-                aCx, (args.length() == 2) ? args[1] : JS::NullValue()
+    PyObject *items = nullptr, *item = nullptr, *entry = nullptr;
+    bool result = false;
+
+    if (!(items = PyObject_GetIter(aObject))) { // +1
+        return false;
+    }
+    // |function| is args[0]
+    JS::RootedValue aFun(aCx, args[0]);
+    // |this| is args[1] if provided
+    JS::RootedValue aThis(
+        aCx, (args.length() == 2) ? args[1] : JS::NullValue()
+    );
+    // |rval| is ignored
+    JS::RootedValue aRv(aCx);
+    // |args| is [value, key, object being traversed]
+    JS::AutoValueArray<3> aArgs(aCx);
+    aArgs[2].set(args.thisv()); // object being traversed
+    for (;;) {
+        if (!(item = PyIter_Next(items))) { // +1
+            result = !PyErr_Occurred();
+            break;
+        }
+        entry = _PySequence_Fast(item, "expected a sequence", 2); // +1
+        Py_DECREF(item); // -1
+        if (!entry) {
+            break;
+        }
+        aArgs[0].set(Wrap(aCx, PySequence_Fast_GET_ITEM(entry, 1))); // borrowed value
+        aArgs[1].set(Wrap(aCx, PySequence_Fast_GET_ITEM(entry, 0))); // borrowed key
+        Py_DECREF(entry); // -1
+        if (
+            aArgs[0].isUndefined() || aArgs[1].isUndefined() ||
+            !JS::Call(aCx, aThis, aFun, aArgs, &aRv)
+        ) {
+            break;
+        }
+    }
+    Py_DECREF(items); // -1
+    return result;
+}
+
+
+// walks an exact dict, set, list or tuple in place, fails if it changes size
+bool
+Type::__walk__(JSContext *aCx, JS::CallArgs &args, PyObject *aObject)
+{
+    PyObject *aKey = nullptr, *aValue = nullptr;
+    Py_ssize_t size = Py_SIZE(aObject), pos = 0, i = 0;
+    Py_hash_t hash;
+
+    if (PyDict_CheckExact(aObject)) {
+        size = PyDict_GET_SIZE(aObject);
+    }
+    else if (PyAnySet_CheckExact(aObject)) {
+        size = PySet_GET_SIZE(aObject);
+    }
+    // |function| is args[0]
+    JS::RootedValue aFun(aCx, args[0]);
+    // |this| is args[1] if provided
+    JS::RootedValue aThis(
+        aCx, (args.length() == 2) ? args[1] : JS::NullValue()
+    );
+    // |rval| is ignored
+    JS::RootedValue aRv(aCx);
+    // |args| is [value, key, object being traversed]
+    JS::AutoValueArray<3> aArgs(aCx);
+    aArgs[2].set(args.thisv()); // object being traversed
+    for (; i < size; i++) {
+        if (PyDict_CheckExact(aObject)) {
+            PY_ENSURE_TRUE(
+                (PyDict_GET_SIZE(aObject) == size), false,
+                PyExc_RuntimeError, "dictionary changed size during iteration"
             );
-            // |rval| is ignored
-            JS::RootedValue aRv(aCx);
-            // |args| is [value, key, object being traversed]
-            JS::AutoValueArray<3> aArgs(aCx);
-            aArgs[2].set(args.thisv()); // object being traversed
-            for (; i < size; i++) {
-                item = PySequence_Fast_GET_ITEM(items, i); // borrowed
-                if (!(item = _PySequence_Fast(item, "expected a sequence", 2))) { // +1
-                    break;
-                }
-                aArgs[0].set(Wrap(aCx, PySequence_Fast_GET_ITEM(item, 1))); // borrowed value
-                aArgs[1].set(Wrap(aCx, PySequence_Fast_GET_ITEM(item, 0))); // borrowed key
-                Py_DECREF(item); // -1
-                if (
-                    aArgs[0].isUndefined() || aArgs[1].isUndefined() ||
-                    !JS::Call(aCx, aThis, aFun, aArgs, &aRv)
-                ) {
-                    break;
-                }
+            if (!PyDict_Next(aObject, &pos, &aKey, &aValue)) { // borrowed
+                break;
+            }
+            aArgs[0].set(Wrap(aCx, aValue));
+            aArgs[1].set(Wrap(aCx, aKey));
+        }
+        else if (PyAnySet_CheckExact(aObject)) {
+            PY_ENSURE_TRUE(
+                (PySet_GET_SIZE(aObject) == size), false,
+                PyExc_RuntimeError, "Set changed size during iteration"
+            );
+            if (!_PySet_NextEntry(aObject, &pos, &aKey, &hash)) { // borrowed
+                break;
             }
+            aArgs[0].set(Wrap(aCx, aKey));
+            aArgs[1].set(aArgs[0]);
+        }
+        else {
+            PY_ENSURE_TRUE(
+                (Py_SIZE(aObject) == size), false,
+                PyExc_RuntimeError, "list changed size during iteration"
+            );
+            aValue = PyTuple_CheckExact(aObject) ?
+                PyTuple_GET_ITEM(aObject, i) : // borrowed
+                PyList_GET_ITEM(aObject, i); // borrowed
+            aArgs[0].set(Wrap(aCx, aValue));
+            aArgs[1].set(JS::NumberValue(i));
+        }
+        if (
+            aArgs[0].isUndefined() || aArgs[1].isUndefined() ||
+            !JS::Call(aCx, aThis, aFun, aArgs, &aRv)
+        ) {
+            break;
         }
-        Py_DECREF(items); // -1
-        return (i == size);
     }
-    return false;
+    return (i == size);
 }
 
 
@@ -484,14 +541,23 @@ Type::ForEach(JSContext *aCx, unsigned argc, JS::Value *vp)
     JSPY_FN_CHECK_VAR_ARGS("forEach", 1, 2, argc);
     AutoResult result = false;
     AutoReporter ar(aCx);
-    PyObject *aObject = nullptr;
+    PyObject *aObject = nullptr, *aItems = nullptr;
 
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     args.rval().setUndefined();
     JS::RootedObject self(aCx, &args.thisv().toObject());
-    if (self && (aObject = T::__iter__(__unwrap__(self), IterType::Entries))) { // +1
-        result = __map__(aCx, args, aObject);
-        Py_DECREF(aObject); // -1
+    if (self && (aObject = __unwrap__(self))) { // borrowed
+        // subclasses may override __iter__ and friends
+        if (
+            PyDict_CheckExact(aObject) || PyAnySet_CheckExact(aObject) ||
+            PyList_CheckExact(aObject) || PyTuple_CheckExact(aObject)
+        ) {
+            result = __walk__(aCx, args, aObject);
+        }
+        else if ((aItems = T::__iter__(aObject, IterType::Entries))) { // +1
+            result = __map__(aCx, args, aItems);
+            Py_DECREF(aItems); // -1
+        }
     }
     return bool(result);
 }
@@ -559,6 +625,9 @@ Type::New(JSContext* aCx, PyObject *aType, const JS::HandleObject &aProto)
     if (_PyType_IsIterator(type)) {
         return Alloc<Type::Iterator>(aCx, aType, aProto, true);
     }
+    if (_PyType_IsAsyncIterable(type)) {
+        return Alloc<Type::AsyncIterator>(aCx, aType, aProto, true);
+    }
     if (_PyType_IsMapping(type)) {
         return Alloc<Type::Mapping>(aCx, aType, aProto, true);
     }
@@ -583,7 +652,7 @@ Type::GetProto(JSContext* aCx, PyTypeObject *aType)
 bool
 Type::Check(const JS::HandleObject &aJSObject)
 {
-    dom::AutoEntryScript aes(aJSObject, "jspy::Type::Check");
+    AutoScript aes(aJSObject, "jspy::Type::Check");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -698,17 +767,6 @@ Type::Iterator::__legacy__(JSContext *aCx, unsigned argc, JS::Value *vp)
 }
 
 
-// Type::Iterator::Next
-bool
-Type::Iterator::Next(JSContext *aCx, unsigned argc, JS::Value *vp)
-{
-    AutoGILState ags; // XXX: important
-
-    PyErr_SetNone(PyExc_NotImplementedError);
-    return xpc::ReportError();
-}
-
-
 /* public ------------------------------------------------------------------- */
 
 // Type::Iterator::Functions
@@ -716,7 +774,7 @@ const JSFunctionSpec Type::Iterator::Functions[] = {
     JS_SYM_FN(iterator, Type::Iterator::GetIterator, 0, JSPY_PROP_FLAGS),
     JS_FN("__next__", Type::Iterator::__next__, 0, JSPY_PROP_FLAGS),
     JS_FN("__legacy__", Type::Iterator::__legacy__, 0, JSPY_PROP_FLAGS),
-    JS_FN("next", Type::Iterator::Next, 0, 0),
+    JS_FN("next", Type::Iterator::__next__, 0, JSPY_PROP_FLAGS),
     JS_FS_END
 };
 
@@ -727,6 +785,165 @@ const JSPropertySpec Type::Iterator::Properties[] = {
 };
 
 
+// Type::Iterator::LegacyFunctions
+const JSFunctionSpec Type::Iterator::LegacyFunctions[] = {
+    JS_SYM_FN(iterator, Type::Iterator::GetIterator, 0, JSPY_PROP_FLAGS),
+    JS_FN("next", Type::Iterator::__legacy__, 0, JSPY_PROP_FLAGS),
+    JS_FS_END
+};
+
+
+// Type::Iterator::LegacyProto
+JS::PersistentRootedObject Type::Iterator::LegacyProto;
+
+
+// modern iterators are plain wrappers (their type proto has the right next),
+// legacy ones share LegacyProto so no prototype is ever mutated
+JSObject *
+Type::Iterator::New(JSContext *aCx, PyObject *aIter, bool legacy)
+{
+    if (!legacy) {
+        return Object::__new__(aCx, aIter); // no caching
+    }
+    JSAutoCompartment ac(aCx, LegacyProto);
+    return Alloc<Object>(aCx, LegacyProto, aIter);
+}
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::jspy::Type::AsyncIterator
+   -------------------------------------------------------------------------- */
+
+// Type::AsyncIterator::GetAsyncIterator
+bool
+Type::AsyncIterator::GetAsyncIterator(
+    JSContext *aCx, unsigned argc, JS::Value *vp
+)
+{
+    AutoGILState ags; // XXX: important
+
+    JSPY_FN_CHECK_NUM_ARGS("[@@asyncIterator]", 0, argc);
+    AutoResult result = false;
+    AutoReporter ar(aCx);
+    PyObject *aObject = nullptr, *aIter = nullptr;
+
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject self(aCx, &args.thisv().toObject());
+    if (self && (aObject = __unwrap__(self))) { // borrowed
+        if ((aIter = Py_TYPE(aObject)->tp_as_async->am_aiter(aObject))) { // +1
+            args.rval().set(Wrap(aCx, aIter));
+            result = !args.rval().isUndefined();
+            Py_DECREF(aIter); // -1
+        }
+    }
+    return bool(result);
+}
+
+
+// Type::AsyncIterator::Next
+bool
+Type::AsyncIterator::Next(JSContext *aCx, unsigned argc, JS::Value *vp)
+{
+    AutoGILState ags; // XXX: important
+
+    AutoResult result = false;
+    AutoReporter ar(aCx);
+    PyObject *aObject = nullptr, *aAwaitable = nullptr;
+    PyAsyncMethods *aMethods = nullptr;
+
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject self(aCx, &args.thisv().toObject());
+    if (self && (aObject = __unwrap__(self))) { // borrowed
+        aMethods = Py_TYPE(aObject)->tp_as_async;
+        if (!aMethods || !aMethods->am_anext) {
+            PyErr_Format(
+                PyExc_TypeError, "'%.200s' object is not an async iterator",
+                Py_TYPE(aObject)->tp_name
+            );
+        }
+        else if ((aAwaitable = aMethods->am_anext(aObject))) { // +1
+            JS::RootedObject aPromise(
+                aCx, Task::New(aCx, aAwaitable, Task::Next)
+            );
+            if (aPromise) {
+                args.rval().setObject(*aPromise);
+                result = true;
+            }
+            Py_DECREF(aAwaitable); // -1
+        }
+    }
+    return bool(result);
+}
+
+
+// Type::AsyncIterator::Return, closes async generators
+bool
+Type::AsyncIterator::Return(JSContext *aCx, unsigned argc, JS::Value *vp)
+{
+    AutoGILState ags; // XXX: important
+
+    _Py_IDENTIFIER(aclose);
+    AutoResult result = false;
+    AutoReporter ar(aCx);
+    PyObject *aObject = nullptr, *aClose = nullptr, *aAwaitable = nullptr;
+
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject self(aCx, &args.thisv().toObject());
+    JS::RootedObject aPromise(aCx);
+    if (
+        self && (aObject = __unwrap__(self)) && // borrowed
+        (_PyObject_LookupAttrId(aObject, &PyId_aclose, &aClose) >= 0) // +1
+    ) {
+        if (!aClose) { // nothing to close, already done
+            JS::RootedObject aDone(aCx, JS_NewPlainObject(aCx));
+            if (
+                aDone &&
+                JS_DefineProperty(
+                    aCx, aDone, "value", JS::UndefinedHandleValue,
+                    JSPROP_ENUMERATE
+                ) &&
+                JS_DefineProperty(
+                    aCx, aDone, "done", JS::TrueHandleValue, JSPROP_ENUMERATE
+                )
+            ) {
+                JS::RootedValue aValue(aCx, JS::ObjectValue(*aDone));
+                aPromise = JS::CallOriginalPromiseResolve(aCx, aValue);
+            }
+        }
+        else if ((aAwaitable = PyObject_CallNoArgs(aClose))) { // +1
+            aPromise = Task::New(aCx, aAwaitable, Task::Return);
+            Py_DECREF(aAwaitable); // -1
+        }
+        Py_XDECREF(aClose); // -1
+        if (aPromise) {
+            args.rval().setObject(*aPromise);
+            result = true;
+        }
+    }
+    return bool(result);
+}
+
+
+/* public ------------------------------------------------------------------- */
+
+// Type::AsyncIterator::Functions
+const JSFunctionSpec Type::AsyncIterator::Functions[] = {
+    JS_SYM_FN(
+        asyncIterator, Type::AsyncIterator::GetAsyncIterator, 0,
+        JSPY_PROP_FLAGS
+    ),
+    JS_FN("next", Type::AsyncIterator::Next, 0, JSPY_PROP_FLAGS),
+    JS_FN("return", Type::AsyncIterator::Return, 0, JSPY_PROP_FLAGS),
+    JS_FS_END
+};
+
+
+// Type::AsyncIterator::Properties
+const JSPropertySpec Type::AsyncIterator::Properties[] = {
+    JS_PS_END
+};
+
+
 /* --------------------------------------------------------------------------
    pyxul::wrappers::jspy::Type::Mapping
    -------------------------------------------------------------------------- */
@@ -736,11 +953,20 @@ Type::Mapping::__iter__(PyObject *aObject, int type)
 {
     switch (type) {
         case IterType::Keys:
-            return PyMapping_Keys(aObject); // +1
+            if (!PyDict_CheckExact(aObject)) {
+                return PyMapping_Keys(aObject); // +1
+            }
+            return Walker::New(aObject, type); // +1
         case IterType::Values:
-            return PyMapping_Values(aObject); // +1
+            if (!PyDict_CheckExact(aObject)) {
+                return PyMapping_Values(aObject); // +1
+            }
+            return Walker::New(aObject, type); // +1
         case IterType::Entries:
-            return PyMapping_Items(aObject); // +1
+            if (!PyDict_CheckExact(aObject)) {
+                return PyMapping_Items(aObject); // +1
+            }
+            return Walker::New(aObject, type); // +1
         default:
             PyErr_BadArgument();
             return nullptr;
@@ -949,6 +1175,17 @@ Type::Sequence::__iter__(PyObject *aObject, int type)
     static PyObject *Enum = (PyObject *)&PyEnum_Type;
     Py_ssize_t len;
 
+    if (PyTuple_CheckExact(aObject) || PyList_CheckExact(aObject)) {
+        switch (type) {
+            case IterType::Keys:
+            case IterType::Values:
+            case IterType::Entries:
+                return Walker::New(aObject, type); // +1
+            default:
+                PyErr_BadArgument();
+                return nullptr;
+        }
+    }
     if ((len = PySequence_Length(aObject)) >= 0) {
         switch (type) {
             case IterType::Keys:
@@ -1024,6 +1261,17 @@ Type::Set::__iter__(PyObject *aObject, int type)
 {
     static PyObject *Zip = (PyObject *)&PyZip_Type;
 
+    if (PyAnySet_CheckExact(aObject)) {
+        switch (type) {
+            case IterType::Keys:
+            case IterType::Values:
+            case IterType::Entries:
+                return Walker::New(aObject, type); // +1
+            default:
+                PyErr_BadArgument();
+                return nullptr;
+        }
+    }
     switch (type) {
         case IterType::Keys:
         case IterType::Values:
@@ -0,0 +1,193 @@
+/*
+# Python for XUL
+# copyright © 2021 Malek Hadj-Ali
+#
+# This program is free software: you can redistribute it and/or modify it
+# under the terms of the GNU General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "wrappers/api.h"
+#include "wrappers/internals.h"
+
+
+namespace pyxul::wrappers::jspy {
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::jspy::Walker
+   -------------------------------------------------------------------------- */
+
+PyObject *
+Walker::__entry__(Walker *self, PyObject *aKey, PyObject *aValue)
+{
+    switch (self->mType) {
+        case jspy::Type::IterType::Keys:
+            Py_INCREF(aKey);
+            return aKey;
+        case jspy::Type::IterType::Values:
+            Py_INCREF(aValue);
+            return aValue;
+        default:
+            return PyTuple_Pack(2, aKey, aValue);
+    }
+}
+
+
+PyObject *
+Walker::__dict__(Walker *self)
+{
+    PyObject *aKey = nullptr, *aValue = nullptr;
+
+    PY_ENSURE_TRUE(
+        (PyDict_GET_SIZE(self->mObject) == self->mSize), nullptr,
+        PyExc_RuntimeError, "dictionary changed size during iteration"
+    );
+    if (!PyDict_Next(self->mObject, &self->mPos, &aKey, &aValue)) { // borrowed
+        return nullptr;
+    }
+    return __entry__(self, aKey, aValue);
+}
+
+
+PyObject *
+Walker::__sequence__(Walker *self)
+{
+    PyObject *aKey = nullptr, *aValue = nullptr, *result = nullptr;
+
+    PY_ENSURE_TRUE(
+        (Py_SIZE(self->mObject) == self->mSize), nullptr,
+        PyExc_RuntimeError, "list changed size during iteration"
+    );
+    if (self->mPos >= self->mSize) {
+        return nullptr;
+    }
+    aValue = PyTuple_Check(self->mObject) ?
+        PyTuple_GET_ITEM(self->mObject, self->mPos) : // borrowed
+        PyList_GET_ITEM(self->mObject, self->mPos); // borrowed
+    Py_INCREF(aValue); // +1
+    if (self->mType == jspy::Type::IterType::Values) {
+        self->mPos++;
+        return aValue;
+    }
+    if ((aKey = PyLong_FromSsize_t(self->mPos++))) { // +1
+        result = __entry__(self, aKey, aValue);
+        Py_DECREF(aKey); // -1
+    }
+    Py_DECREF(aValue); // -1
+    return result;
+}
+
+
+PyObject *
+Walker::__set__(Walker *self)
+{
+    PyObject *aKey = nullptr;
+    Py_hash_t hash;
+
+    PY_ENSURE_TRUE(
+        (PySet_GET_SIZE(self->mObject) == self->mSize), nullptr,
+        PyExc_RuntimeError, "Set changed size during iteration"
+    );
+    if (!_PySet_NextEntry(self->mObject, &self->mPos, &aKey, &hash)) { // borrowed
+        return nullptr;
+    }
+    return __entry__(self, aKey, aKey);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Walker::Type.tp_dealloc
+void
+Walker::Dealloc(Walker *self)
+{
+    PyObject_GC_UnTrack(self);
+    Py_XDECREF(self->mObject);
+    PyObject_GC_Del(self);
+}
+
+
+// Walker::Type.tp_traverse
+int
+Walker::Traverse(Walker *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->mObject);
+    return 0;
+}
+
+
+// Walker::Type.tp_iternext
+PyObject *
+Walker::Next(Walker *self)
+{
+    PyObject *result = nullptr;
+
+    if (!self->mObject) {
+        return nullptr;
+    }
+    if (PyDict_Check(self->mObject)) {
+        result = __dict__(self);
+    }
+    else if (PyAnySet_Check(self->mObject)) {
+        result = __set__(self);
+    }
+    else {
+        result = __sequence__(self);
+    }
+    if (!result) { // exhausted (or failed), let go of the container
+        Py_CLEAR(self->mObject);
+    }
+    return result;
+}
+
+
+// Walker::Type
+PyTypeObject Walker::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul::wrappers::jspy::Walker",
+    .tp_basicsize = sizeof(Walker),
+    .tp_dealloc = (destructor)Walker::Dealloc,
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC),
+    .tp_traverse = (traverseproc)Walker::Traverse,
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)Walker::Next,
+};
+
+
+/* public ------------------------------------------------------------------- */
+
+// aObject must be a dict, list, tuple, set or frozenset (or a subclass)
+PyObject *
+Walker::New(PyObject *aObject, int aType)
+{
+    Walker *self = nullptr;
+
+    if ((self = PyObject_GC_New(Walker, &Walker::Type))) {
+        Py_INCREF(aObject);
+        self->mObject = aObject;
+        self->mPos = 0;
+        self->mSize = Py_SIZE(aObject);
+        self->mType = aType;
+        if (PyDict_Check(aObject)) {
+            self->mSize = PyDict_GET_SIZE(aObject);
+        }
+        else if (PyAnySet_Check(aObject)) {
+            self->mSize = PySet_GET_SIZE(aObject);
+        }
+        PyObject_GC_Track(self);
+    }
+    return self;
+}
+
+
+} // namespace pyxul::wrappers::jspy
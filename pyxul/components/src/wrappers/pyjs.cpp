@@ -26,6 +26,15 @@ namespace pyxul::wrappers::pyjs {
 namespace { // anonymous
 
 
+static void
+__gc__(JSFreeOp *fop, JSFinalizeStatus status, bool isZoneGC, void *data)
+{
+    if (status == JSFINALIZE_GROUP_PREPARE) {
+        Object::Names.invalidate();
+    }
+}
+
+
 } // namespace anonymous
 
 
@@ -181,6 +190,13 @@ Wrap(JSContext *aCx, const JS::HandleValue &aJSValue)
 }
 
 
+PyObject *
+Signature(PyObject *aCallable, PyObject *aArgTypes, PyObject *aResType)
+{
+    return Object::Signature::New(aCallable, aArgTypes, aResType);
+}
+
+
 /* Initialize/Finalize ------------------------------------------------------ */
 
 bool
@@ -189,16 +205,38 @@ Initialize(void)
     if (
         PyType_Ready(&Object::Type) ||
         _PyType_ReadyWithBase(&Object::Iterator::Type, &Object::Type) ||
+        _PyType_ReadyWithBase(&Object::AsyncIterator::Type, &Object::Type) ||
+        _PyType_ReadyWithBase(&Object::Awaitable::Type, &Object::Type) ||
+        _PyType_ReadyWithBase(&Object::Entries::Type, &Object::Type) ||
         _PyType_ReadyWithBase(&Object::Array::Type, &Object::Type) ||
+        _PyType_ReadyWithBase(&Object::Array::Iterator::Type, &Object::Type) ||
         _PyType_ReadyWithBase(&Object::Map::Type, &Object::Type) ||
+        _PyType_ReadyWithBase(&Object::Map::View::Type, &Object::Type) ||
         _PyType_ReadyWithBase(&Object::Set::Type, &Object::Type) ||
-        _PyType_ReadyWithBase(&Object::Callable::Type, &Object::Type)
+        _PyType_ReadyWithBase(&Object::Callable::Type, &Object::Type) ||
+        _PyType_ReadyWithBase(&Object::Promise::Type, &Object::Type) ||
+        _PyType_ReadyWithBase(&Object::Signature::Type, &Object::Type)
     ) {
         return false;
     }
+    AutoJSContext aCx;
+    PY_ENSURE_TRUE(
+        JS_AddFinalizeCallback(aCx, __gc__, nullptr), false,
+        errors::JSError, "Failed to add finalize callback"
+    );
     return true;
 }
 
 
+void
+Finalize(void)
+{
+    AutoJSContext aCx;
+
+    JS_RemoveFinalizeCallback(aCx, __gc__);
+    Object::Names.finalize();
+}
+
+
 } // namespace pyxul::wrappers::pyjs
 
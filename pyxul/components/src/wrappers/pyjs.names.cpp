@@ -0,0 +1,216 @@
+/*
+# Python for XUL
+# copyright © 2021 Malek Hadj-Ali
+#
+# This program is free software: you can redistribute it and/or modify it
+# under the terms of the GNU General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "wrappers/api.h"
+#include "wrappers/internals.h"
+
+#include "nsTArray.h"
+
+
+namespace pyxul::wrappers::pyjs {
+
+
+namespace { // anonymous
+
+
+// plain native objects, without resolve or property hooks, whose shape
+// changes whenever a property is added
+static inline bool
+__cacheable__(JSObject *aJSObject)
+{
+    const js::Class *aClass = js::GetObjectClass(aJSObject);
+
+    return (
+        aClass->isNative() && !aClass->getResolve() &&
+        !aClass->getGetProperty() && !aClass->getOpsGetProperty() &&
+        !aClass->getOpsLookupProperty()
+    );
+}
+
+
+static inline const void *
+__shape__(JSObject *aJSObject)
+{
+    return reinterpret_cast<const js::shadow::Object *>(aJSObject)->shape;
+}
+
+
+static inline JSObject *
+__proto__(JSObject *aJSObject)
+{
+    return reinterpret_cast<const js::shadow::Object *>(aJSObject)->group->proto;
+}
+
+
+} // namespace anonymous
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::pyjs::NameCache::Entry
+   -------------------------------------------------------------------------- */
+
+class NameCache::Entry final {
+    public:
+        explicit Entry(jsid aId) : mId(aId), mGeneration(0), mShapes() {
+        }
+
+        jsid mId;
+        uint32_t mGeneration;
+        nsTArray<const void *> mShapes;
+};
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::pyjs::NameCache
+   -------------------------------------------------------------------------- */
+
+NameCache::NameCache() : mTable(32), mGeneration(1)
+{
+}
+
+
+NameCache::~NameCache()
+{
+    mTable.Clear();
+}
+
+
+bool
+NameCache::getId(JSContext *aCx, PyObject *aName, JS::MutableHandleId aId)
+{
+    Entry *aEntry = nullptr;
+    JSString *aAtom = nullptr;
+    JSLinearString *aLinear = nullptr;
+    uint32_t index = 0;
+
+    if ((aEntry = mTable.Get(aName))) {
+        aId.set(aEntry->mId);
+        return true;
+    }
+    JS::RootedValue aJSName(aCx, jspy::WrapUnicode(aCx, aName));
+    if (aJSName.isUndefined()) {
+        return false;
+    }
+    // only interned names are worth keeping (and pinning)
+    if (!PyUnicode_CheckExact(aName) || !PyUnicode_CHECK_INTERNED(aName)) {
+        return JS_ValueToId(aCx, aJSName, aId);
+    }
+    JS::RootedString aJSString(aCx, aJSName.toString());
+    if (!(aLinear = JS_EnsureLinearString(aCx, aJSString))) {
+        return false;
+    }
+    // "0", "42"... are int jsids, and adding elements doesn't change shapes
+    // (isMissing would go stale), don't cache them
+    if (js::StringIsArrayIndex(aLinear, &index)) {
+        return JS_StringToId(aCx, aJSString, aId);
+    }
+    if (!(aAtom = JS_AtomizeAndPinJSString(aCx, aJSString))) {
+        return false;
+    }
+    aId.set(INTERNED_STRING_TO_JSID(aCx, aAtom));
+    Py_INCREF(aName); // released in finalize()
+    mTable.Put(aName, new Entry(aId));
+    return true;
+}
+
+
+bool
+NameCache::isMissing(JSObject *aJSObject, PyObject *aName)
+{
+    Entry *aEntry = nullptr;
+    size_t size = 0, i = 0;
+
+    if (
+        !(aEntry = mTable.Get(aName)) ||
+        (aEntry->mGeneration != mGeneration)
+    ) {
+        return false;
+    }
+    size = aEntry->mShapes.Length();
+    for (; aJSObject; aJSObject = __proto__(aJSObject), i++) {
+        if (
+            i >= size || !__cacheable__(aJSObject) ||
+            __shape__(aJSObject) != aEntry->mShapes[i]
+        ) {
+            return false;
+        }
+    }
+    return (i == size);
+}
+
+
+// returns false if an error occurred
+bool
+NameCache::setMissing(
+    JSContext *aCx, JS::HandleObject aJSObject, JS::HandleId aId,
+    PyObject *aName
+)
+{
+    Entry *aEntry = nullptr;
+    JSObject *aObject = nullptr;
+    bool found = false;
+
+    if (!(aEntry = mTable.Get(aName))) {
+        return true;
+    }
+    aEntry->mGeneration = 0;
+    aEntry->mShapes.Clear();
+    for (aObject = aJSObject; aObject; aObject = __proto__(aObject)) {
+        if (!__cacheable__(aObject)) {
+            aEntry->mShapes.Clear();
+            return true;
+        }
+        aEntry->mShapes.AppendElement(__shape__(aObject));
+    }
+    // undefined is not the same as missing
+    if (!JS_HasPropertyById(aCx, aJSObject, aId, &found)) {
+        aEntry->mShapes.Clear();
+        return false;
+    }
+    if (!found) {
+        aEntry->mGeneration = mGeneration;
+    }
+    return true;
+}
+
+
+// shapes can be collected and their addresses reused, called on each GC
+void
+NameCache::invalidate()
+{
+    if (!++mGeneration) {
+        mGeneration = 1;
+    }
+}
+
+
+void
+NameCache::finalize()
+{
+    PyObject *aName = nullptr;
+
+    for (auto iter = mTable.Iter(); !iter.Done(); iter.Next()) {
+        aName = iter.Key();
+        iter.Remove();
+        Py_DECREF(aName);
+    }
+}
+
+
+} // namespace pyxul::wrappers::pyjs
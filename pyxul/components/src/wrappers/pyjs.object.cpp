@@ -29,6 +29,40 @@ namespace { // anonymous
 static std::allocator<JS::PersistentRootedObject> alloc;
 
 
+// number of elements read at once by bulk operations on arrays
+static const uint32_t chunkSize = 4096;
+
+
+// wakes an asyncio future waiting on an Awaitable, unless it is already done
+// (cancelled, i.e. by wait_for() or Task.cancel())
+static PyObject *
+__wake__(PyObject *aFuture, PyObject *unused)
+{
+    _Py_IDENTIFIER(done);
+    _Py_IDENTIFIER(set_result);
+    PyObject *aDone = nullptr, *aResult = nullptr;
+
+    if ((aDone = _PyObject_CallMethodIdNoArgs(aFuture, &PyId_done))) { // +1
+        if (aDone == Py_False) {
+            aResult = _PyObject_CallMethodIdOneArg(
+                aFuture, &PyId_set_result, Py_None
+            ); // +1
+        }
+        else {
+            Py_INCREF(Py_None);
+            aResult = Py_None;
+        }
+        Py_DECREF(aDone); // -1
+    }
+    return aResult;
+}
+
+
+static PyMethodDef __wake_def__ = {
+    "__wake__", (PyCFunction)__wake__, METH_O, nullptr
+};
+
+
 } // namespace anonymous
 
 
@@ -93,17 +127,17 @@ Object::__str__(JSContext *aCx, Object *self)
 }
 
 
+// returns nullptr without an exception set if the property is undefined
 PyObject *
-Object::__getattr__(JSContext *aCx, Object *self, const char *aName)
+Object::__getattr__(JSContext *aCx, Object *self, JS::HandleId aId)
 {
     JS::RootedValue aResult(aCx, JS::UndefinedValue());
-    if (!JS_GetProperty(aCx, self->mJSObject, aName, &aResult)) {
+    if (
+        !JS_GetPropertyById(aCx, self->mJSObject, aId, &aResult) ||
+        aResult.isUndefined()
+    ) {
         return nullptr;
     }
-    PY_ENSURE_TRUE(
-        !aResult.isUndefined(), nullptr,
-        PyExc_AttributeError, "%S has no attribute '%s'", self, aName
-    );
     if (aResult.isObject()) {
         JS::RootedObject aJSObject(aCx, &aResult.toObject());
         PY_ENSURE_TRUE(
@@ -159,7 +193,7 @@ Object::__compare__(Object *self, PyObject *aOther, int op)
 {
     bool equals = false;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::__compare__");
+    AutoScript aes(self->mJSObject, "pyjs::Object::__compare__");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -243,7 +277,7 @@ Object::Repr(Object *self)
 {
     PyObject *result = nullptr, *aRepr = nullptr;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Repr");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Repr");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -270,7 +304,7 @@ Object::Hash(Object *self)
 PyObject *
 Object::Str(Object *self)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Str");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Str");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -282,24 +316,24 @@ Object::Str(Object *self)
 PyObject *
 Object::GetAttrO(Object *self, PyObject *aName)
 {
-    const char *name = nullptr;
     PyObject *result = nullptr;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::GetAttrO");
+    // known to be missing, don't bother JS
+    if (Names.isMissing(self->mJSObject, aName)) {
+        return PyObject_GenericGetAttr(self, aName);
+    }
+
+    AutoScript aes(self->mJSObject, "pyjs::Object::GetAttrO");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
-    /*if ((name = PyUnicode_AsUTF8(aName))) {
-        return __getattr__(aCx, self, name);
-    }
-    return nullptr;*/
-
-    if ((name = PyUnicode_AsUTF8(aName))) {
-        if (
-            !(result = __getattr__(aCx, self, name)) &&
-            PyErr_ExceptionMatches(PyExc_AttributeError)
-        ) {
-            PyErr_Clear();
+    JS::RootedId aId(aCx);
+    if (
+        Names.getId(aCx, aName, &aId) &&
+        !(result = __getattr__(aCx, self, aId)) &&
+        !JS_IsExceptionPending(aCx) && !PyErr_Occurred()
+    ) {
+        if (Names.setMissing(aCx, self->mJSObject, aId, aName)) {
             result = PyObject_GenericGetAttr(self, aName);
         }
     }
@@ -313,7 +347,7 @@ Object::SetAttrO(Object *self, PyObject *aName, PyObject *aValue)
 {
     const char *name = nullptr;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::SetAttrO");
+    AutoScript aes(self->mJSObject, "pyjs::Object::SetAttrO");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -343,7 +377,7 @@ template<typename T>
 PyObject *
 Object::Iter(Object *self)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Iter");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Iter");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -360,6 +394,47 @@ Object::Iter(Object *self)
 }
 
 
+// Object::AsAsync.am_aiter
+PyObject *
+Object::AIter(Object *self)
+{
+    AutoScript aes(self->mJSObject, "pyjs::Object::AIter");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    // get the @@asyncIterator method
+    JS::RootedId aId(
+        aCx,
+        SYMBOL_TO_JSID(
+            JS::GetWellKnownSymbol(aCx, JS::SymbolCode::asyncIterator)
+        )
+    );
+    JS::RootedValue aCallee(aCx);
+    if (!JS_GetPropertyById(aCx, self->mJSObject, aId, &aCallee)) {
+        return nullptr;
+    }
+    PY_ENSURE_TRUE(
+        (aCallee.isObject() && JS::IsCallable(&aCallee.toObject())), nullptr,
+        PyExc_TypeError, "%S is not async iterable", self
+    );
+    JS::RootedValue aResult(aCx);
+    if (
+        !JS::Call(
+            aCx, self->mJSObject, aCallee, JS::HandleValueArray::empty(),
+            &aResult
+        )
+    ) {
+        return nullptr;
+    }
+    PY_ENSURE_TRUE(
+        aResult.isObject(), nullptr, PyExc_TypeError,
+        "%S[@@asyncIterator]() returned a non-object value", self
+    );
+    JS::RootedObject aIterator(aCx, &aResult.toObject());
+    return Alloc<Object::AsyncIterator>(aCx, aIterator, nullptr);
+}
+
+
 // Object::Dir
 PyObject *
 Object::Dir(Object *self)
@@ -367,7 +442,7 @@ Object::Dir(Object *self)
     PyObject *aNames = nullptr, *aName = nullptr;
     size_t aLength, i;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Dir");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Dir");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -405,12 +480,19 @@ Object::Finalize(Object *self)
 }
 
 
+// Object::AsAsync
+PyAsyncMethods Object::AsAsync = {
+    .am_aiter = (unaryfunc)Object::AIter,
+};
+
+
 // Object::Type
 PyTypeObject Object::Type = {
     PyVarObject_HEAD_INIT(nullptr, 0)
     .tp_name = "pyxul::wrappers::pyjs::Object",
     .tp_basicsize = sizeof(Object),
     .tp_dealloc = (destructor)Object::Dealloc,
+    .tp_as_async = &Object::AsAsync,
     .tp_repr = (reprfunc)Object::Repr,
     .tp_hash = (hashfunc)Object::Hash,
     .tp_str = (reprfunc)Object::Str,
@@ -424,6 +506,10 @@ PyTypeObject Object::Type = {
 };
 
 
+// Object::Names
+NameCache Object::Names;
+
+
 /* -------------------------------------------------------------------------- */
 
 // Object::New
@@ -436,6 +522,7 @@ Object::New(
     bool check = false;
 
     JSAutoCompartment ac(aCx, aJSObject);
+    JS::RootedObject aUnwrapped(aCx);
 
     if (!JS_IsArrayObject(aCx, aJSObject, &check)) {
         return nullptr;
@@ -458,6 +545,9 @@ Object::New(
     if (JS::IsCallable(aJSObject)) {
         return Alloc<Object::Callable>(aCx, aJSObject, aThis);
     }
+    if ((aUnwrapped = js::CheckedUnwrap(aJSObject)) && JS::IsPromiseObject(aUnwrapped)) {
+        return Alloc<Object::Promise>(aCx, aJSObject, aThis);
+    }
     return Alloc<Object>(aCx, aJSObject, aThis);
 }
 
@@ -516,7 +606,7 @@ Object::Iterator::__next__(JSContext *aCx, Object *self)
 PyObject *
 Object::Iterator::Next(Object *self)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Iterator::Next");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Iterator::Next");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -536,200 +626,875 @@ PyTypeObject Object::Iterator::Type = {
 
 
 /* --------------------------------------------------------------------------
-   pyxul::wrappers::pyjs::Object::Array
+   pyxul::wrappers::pyjs::Object::AsyncIterator
    -------------------------------------------------------------------------- */
 
-bool
-Object::Array::__check__(PyObject *aOther)
-{
-    return (
-        PySequence_Check(aOther) ||
-        PyObject_TypeCheck(aOther, &Object::Array::Type)
-    );
-}
-
-
+// Object::AsyncIterator::AsAsync.am_anext
 PyObject *
-Object::Array::__getElement__(JSContext *aCx, Object *self, uint32_t aIdx)
+Object::AsyncIterator::ANext(Object *self)
 {
-    JS::RootedValue aResult(aCx, JS::UndefinedValue());
-    if (!JS_GetElement(aCx, self->mJSObject, aIdx, &aResult)) {
+    AutoScript aes(self->mJSObject, "pyjs::Object::AsyncIterator::ANext");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    JS::RootedValue aResult(aCx);
+    if (
+        !JS::Call(
+            aCx, self->mJSObject, "next", JS::HandleValueArray::empty(), &aResult
+        )
+    ) {
         return nullptr;
     }
-    return Wrap(aCx, aResult);
+    return Awaitable::New(aCx, aResult, Awaitable::Next);
 }
 
 
-int
-Object::Array::__setElement__(
-    JSContext *aCx, Object *self, uint32_t aIdx, PyObject *aValue
+// Object::AsyncIterator::AsAsync
+PyAsyncMethods Object::AsyncIterator::AsAsync = {
+    .am_aiter = (unaryfunc)PyObject_SelfIter,
+    .am_anext = (unaryfunc)Object::AsyncIterator::ANext,
+};
+
+
+// Object::AsyncIterator::Type
+PyTypeObject Object::AsyncIterator::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul::wrappers::pyjs::Object::AsyncIterator",
+    .tp_basicsize = sizeof(Object),
+    .tp_as_async = &Object::AsyncIterator::AsAsync,
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_FINALIZE),
+};
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::pyjs::Object::Awaitable
+   -------------------------------------------------------------------------- */
+
+// the settled value (or StopAsyncIteration for a finished async iterator),
+// a rejection becomes the pending Python exception
+bool
+Object::Awaitable::__settle__(
+    JSContext *aCx, Awaitable *self, bool aFulfilled, JS::HandleValue aValue
 )
 {
-    JS::RootedValue aJSValue(aCx, jspy::Wrap(aCx, aValue));
-    if (
-        aJSValue.isUndefined() ||
-        !JS_SetElement(aCx, self->mJSObject, aIdx, aJSValue)
-    ) {
-        return -1;
+    PyObject *aReason = nullptr;
+
+    JS::RootedValue aJSValue(aCx, aValue);
+    if (!aFulfilled) {
+        {
+            AutoReporter ar(aCx); // translates error objects
+            JS_SetPendingException(aCx, aJSValue);
+        }
+        if (JS_IsExceptionPending(aCx)) {
+            JS_ClearPendingException(aCx);
+            if (aJSValue.isUndefined()) {
+                PyErr_SetString(errors::JSError, "promise rejected");
+            }
+            else if ((aReason = Wrap(aCx, aJSValue))) { // +1
+                PyErr_SetObject(errors::JSError, aReason);
+                Py_DECREF(aReason); // -1
+            }
+        }
+        return false;
     }
-    return 0;
+    if (self->mKind == Next) {
+        PY_ENSURE_TRUE(
+            aJSValue.isObject(), false, PyExc_TypeError,
+            "iterator.next() resolved to a non-object value"
+        );
+        JS::RootedObject aResult(aCx, &aJSValue.toObject());
+        if (!JS_GetProperty(aCx, aResult, "done", &aJSValue)) {
+            return false;
+        }
+        if (JS::ToBoolean(aJSValue)) { // exhausted
+            self->mState = Done;
+            return true;
+        }
+        if (!JS_GetProperty(aCx, aResult, "value", &aJSValue)) {
+            return false;
+        }
+    }
+    if (aJSValue.isUndefined()) {
+        Py_INCREF(Py_None);
+        self->mResult = Py_None;
+    }
+    else if (!(self->mResult = Wrap(aCx, aJSValue))) {
+        return false;
+    }
+    self->mState = Fulfilled;
+    return true;
 }
 
 
+// with a running asyncio loop wait on one of its futures, else yield self
+// for a jspy::Task to Wait() on
 PyObject *
-Object::Array::__getElements__(
-    JSContext *aCx, Object *self, uint32_t aStart, uint32_t aCount
-)
+Object::Awaitable::__wait__(Awaitable *self)
 {
-    JS::AutoValueArray<2> aJSArgs(aCx);
-    aJSArgs[0].setNumber(aStart);
-    aJSArgs[1].setNumber(aCount);
-    JS::RootedValue aResult(aCx, JS::UndefinedValue());
-    if (!JS::Call(aCx, self->mJSObject, "slice", aJSArgs, &aResult)) {
+    _Py_IDENTIFIER(_get_running_loop);
+    _Py_IDENTIFIER(create_future);
+    _Py_IDENTIFIER(_asyncio_future_blocking);
+    PyObject *aAsyncio = nullptr, *aLoop = nullptr, *aFuture = nullptr;
+    PyObject *aCallback = nullptr;
+
+    if (!(aAsyncio = PyImport_ImportModule("asyncio"))) { // +1
         return nullptr;
     }
-    PY_ENSURE_TRUE(
-        aResult.isObject(), nullptr, PyExc_TypeError,
-        "Array.slice() returned a non-object value"
-    );
-    return Wrap(aCx, aResult);
+    aLoop = _PyObject_CallMethodIdNoArgs(aAsyncio, &PyId__get_running_loop); // +1
+    Py_DECREF(aAsyncio); // -1
+    if (!aLoop) {
+        return nullptr;
+    }
+    if (aLoop == Py_None) {
+        Py_DECREF(aLoop); // -1
+        Py_INCREF(self);
+        return self;
+    }
+    if ((aFuture = _PyObject_CallMethodIdNoArgs(aLoop, &PyId_create_future))) { // +1
+        if (
+            !(aCallback = PyCFunction_New(&__wake_def__, aFuture)) || // +1
+            Wait(self, aCallback) ||
+            _PyObject_SetAttrId(
+                aFuture, &PyId__asyncio_future_blocking, Py_True
+            )
+        ) {
+            Py_CLEAR(aFuture);
+        }
+        Py_XDECREF(aCallback); // -1
+    }
+    Py_DECREF(aLoop); // -1
+    return aFuture;
 }
 
 
-int
-Object::Array::__setElements__(
-    JSContext *aCx, Object *self, uint32_t aStart, uint32_t aCount,
-    PyObject *aValue
-)
+/* -------------------------------------------------------------------------- */
+
+// the promise reactions, slot 0 holds the Awaitable, slot 1 if fulfilled
+bool
+Object::Awaitable::Settle(JSContext *aCx, unsigned argc, JS::Value *vp)
 {
-    PyObject *aArgs = nullptr, *aTmp = nullptr;
-    int res = -1;
+    AutoGILState ags; // XXX: important
 
-    if ((aArgs = Py_BuildValue("[kk]", aStart, aCount))) { // +1
-        if ((aTmp = _PyList_Extend((PyListObject *)aArgs, aValue))) { // +1
-            Py_DECREF(aTmp); // -1
-            JS::AutoValueVector aJSArgs(aCx);
-            if (jspy::WrapArgs(aCx, aArgs, aJSArgs)) {
-                JS::RootedValue aIgnored(aCx, JS::UndefinedValue()); // ignored
-                if (JS::Call(aCx, self->mJSObject, "splice", aJSArgs, &aIgnored)) {
-                    res = 0;
-                }
+    AutoReporter ar(aCx);
+    PyObject *aWaiters = nullptr, *aResult = nullptr;
+    PyObject *err_type = nullptr, *err_inst = nullptr, *err_trbk = nullptr;
+    Py_ssize_t size = 0, i;
+    bool fulfilled = false;
+
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    Awaitable *self = (Awaitable *)js::GetFunctionNativeReserved(
+        &args.callee(), 0
+    ).toPrivate();
+    fulfilled = js::GetFunctionNativeReserved(&args.callee(), 1).toBoolean();
+    args.rval().setUndefined();
+    if (self->mState == Pending) {
+        if (!__settle__(aCx, self, fulfilled, args.get(0))) {
+            self->mState = Rejected;
+            PyErr_Fetch(&err_type, &err_inst, &err_trbk);
+            PyErr_NormalizeException(&err_type, &err_inst, &err_trbk);
+            if (err_trbk) {
+                PyException_SetTraceback(err_inst, err_trbk);
             }
+            Py_XDECREF(self->mResult);
+            self->mResult = err_inst;
+            Py_XDECREF(err_trbk);
+            Py_XDECREF(err_type);
         }
-        Py_DECREF(aArgs); // -1
     }
-    return res;
+    // wake everyone waiting
+    if ((aWaiters = self->mWaiters)) {
+        self->mWaiters = nullptr;
+        size = PyList_GET_SIZE(aWaiters);
+        for (i = 0; i < size; i++) {
+            aResult = PyObject_CallOneArg(
+                PyList_GET_ITEM(aWaiters, i), Py_None // borrowed
+            );
+            if (!aResult) { // cancelled futures are skipped, this is real
+                PyErr_WriteUnraisable(PyList_GET_ITEM(aWaiters, i));
+            }
+            Py_XDECREF(aResult);
+        }
+        Py_DECREF(aWaiters);
+    }
+    Py_DECREF(self); // taken in New()
+    return true;
 }
 
 
-int
-Object::Array::__delElements__(
-    JSContext *aCx, Object *self, uint32_t aStart, uint32_t aCount
-)
+// Object::Awaitable::AsAsync.am_await
+PyObject *
+Object::Awaitable::Await(Awaitable *self)
 {
-    JS::AutoValueArray<2> aJSArgs(aCx);
-    aJSArgs[0].setNumber(aStart);
-    aJSArgs[1].setNumber(aCount);
-    JS::RootedValue aIgnored(aCx, JS::UndefinedValue()); // ignored
-    return JS::Call(aCx, self->mJSObject, "splice", aJSArgs, &aIgnored) ? 0 : -1;
+    Py_INCREF(self);
+    return self;
 }
 
 
-/* -------------------------------------------------------------------------- */
-
-Py_ssize_t
-Object::Array::__len__(JSContext *aCx, Object *self)
+// Object::Awaitable::Type.tp_iternext
+PyObject *
+Object::Awaitable::Next(Awaitable *self)
 {
-    uint32_t aLen;
-
-    if (!JS_GetArrayLength(aCx, self->mJSObject, &aLen)) {
-        return -1;
+    switch (self->mState) {
+        case Fulfilled:
+            _PyGen_SetStopIterationValue(self->mResult);
+            return nullptr;
+        case Done:
+            PyErr_SetNone(PyExc_StopAsyncIteration);
+            return nullptr;
+        case Rejected:
+            PyErr_SetObject((PyObject *)Py_TYPE(self->mResult), self->mResult);
+            return nullptr;
+        default:
+            return __wait__(self);
     }
-    return aLen;
 }
 
 
+// Object::Awaitable::Type.tp_finalize
+void
+Object::Awaitable::Finalize(Awaitable *self)
+{
+    Py_CLEAR(self->mWaiters);
+    Py_CLEAR(self->mResult);
+    Object::Finalize(self);
+}
+
+
+// Object::Awaitable::AsAsync
+PyAsyncMethods Object::Awaitable::AsAsync = {
+    .am_await = (unaryfunc)Object::Awaitable::Await,
+};
+
+
+// Object::Awaitable::Type
+PyTypeObject Object::Awaitable::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul::wrappers::pyjs::Object::Awaitable",
+    .tp_basicsize = sizeof(Object::Awaitable),
+    .tp_as_async = &Object::Awaitable::AsAsync,
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_FINALIZE),
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)Object::Awaitable::Next,
+    .tp_finalize = (destructor)Object::Awaitable::Finalize,
+};
+
+
+/* public ------------------------------------------------------------------- */
+
+// aValue is resolved through the original Promise.resolve, so any thenable
+// will do
 PyObject *
-Object::Array::__getitem__(JSContext *aCx, Object *self, Py_ssize_t aIdx)
+Object::Awaitable::New(JSContext *aCx, const JS::HandleValue &aValue, int aKind)
 {
-    bool found = false;
+    Awaitable *self = nullptr;
+    JSFunction *aFunction = nullptr;
 
-    PY_ENSURE_TRUE(
-        (aIdx <= UINT32_MAX), nullptr, PyExc_OverflowError,
-        "index too big for JavaScript"
-    );
-    if (!JS_HasElement(aCx, self->mJSObject, aIdx, &found)) {
+    JS::RootedObject aPromise(aCx, JS::CallOriginalPromiseResolve(aCx, aValue));
+    if (!aPromise) {
         return nullptr;
     }
-    PY_ENSURE_TRUE(found, nullptr, PyExc_IndexError, "index out of range");
-    return __getElement__(aCx, self, aIdx);
+    JS::RootedObject aOnFulfilled(aCx), aOnRejected(aCx);
+    if (!(aFunction = js::NewFunctionWithReserved(aCx, Settle, 1, 0, nullptr))) {
+        return nullptr;
+    }
+    aOnFulfilled = JS_GetFunctionObject(aFunction);
+    if (!(aFunction = js::NewFunctionWithReserved(aCx, Settle, 1, 0, nullptr))) {
+        return nullptr;
+    }
+    aOnRejected = JS_GetFunctionObject(aFunction);
+    if ((self = (Awaitable *)Alloc<Object::Awaitable>(aCx, aPromise, nullptr))) {
+        self->mKind = aKind;
+        self->mState = Pending;
+        js::SetFunctionNativeReserved(aOnFulfilled, 0, JS::PrivateValue(self));
+        js::SetFunctionNativeReserved(aOnFulfilled, 1, JS::TrueValue());
+        js::SetFunctionNativeReserved(aOnRejected, 0, JS::PrivateValue(self));
+        js::SetFunctionNativeReserved(aOnRejected, 1, JS::FalseValue());
+        if (!JS::AddPromiseReactions(aCx, aPromise, aOnFulfilled, aOnRejected)) {
+            Py_CLEAR(self);
+        }
+        else {
+            Py_INCREF(self); // released by Settle()
+        }
+    }
+    return self;
 }
 
 
+// call aCallback(None) once the promise is settled
 int
-Object::Array::__setitem__(
-    JSContext *aCx, Object *self, Py_ssize_t aIdx, PyObject *aValue
-)
+Object::Awaitable::Wait(PyObject *aAwaitable, PyObject *aCallback)
 {
-    bool found = false;
+    Awaitable *self = (Awaitable *)aAwaitable;
+    PyObject *aResult = nullptr;
 
-    PY_ENSURE_TRUE(
-        (aIdx <= UINT32_MAX), -1, PyExc_OverflowError,
-        "assignment index too big for JavaScript"
-    );
-    if (!JS_HasElement(aCx, self->mJSObject, aIdx, &found)) {
-        return -1;
+    if (self->mState != Pending) {
+        if (!(aResult = PyObject_CallOneArg(aCallback, Py_None))) {
+            return -1;
+        }
+        Py_DECREF(aResult);
+        return 0;
     }
-    PY_ENSURE_TRUE(found, -1, PyExc_IndexError, "assignment index out of range");
-    if (aValue) {
-        return __setElement__(aCx, self, aIdx, aValue);
+    if (!self->mWaiters && !(self->mWaiters = PyList_New(0))) {
+        return -1;
     }
-    return __delElements__(aCx, self, aIdx, 1);
+    return PyList_Append(self->mWaiters, aCallback);
 }
 
 
-PyObject *
-Object::Array::__getslice__(
-    JSContext *aCx, Object *self, PyObject *aSlice, Py_ssize_t aLen
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::pyjs::Object::Entries
+   -------------------------------------------------------------------------- */
+
+// pull up to aCount values out of aIterator
+bool
+Object::Entries::__read__(
+    JSContext *aCx, const JS::HandleValue &aIterator, uint32_t aCount,
+    JS::AutoValueVector &aValues, bool *aDone
 )
 {
-    Py_ssize_t start, stop, slicelength;
+    JS::ForOfIterator aForOf(aCx);
+    JS::RootedValue aJSValue(aCx);
 
-    if (_PySlice_GetIndices(aSlice, aLen, &start, &stop, &slicelength)) {
-        return nullptr;
+    aValues.clear();
+    *aDone = false;
+    if (!aForOf.init(aIterator)) {
+        return false;
     }
-    PY_ENSURE_TRUE(
-        ((start + stop) <= UINT32_MAX), nullptr,
-        PyExc_IndexError, "slice out of range"
-    );
-    return __getElements__(aCx, self, start, stop);
+    while (aValues.length() < aCount) {
+        if (!aForOf.next(&aJSValue, aDone)) {
+            return false;
+        }
+        if (*aDone) {
+            break;
+        }
+        if (!aValues.append(aJSValue)) {
+            PyErr_NoMemory();
+            return false;
+        }
+    }
+    return true;
 }
 
 
-int
-Object::Array::__setslice__(
-    JSContext *aCx, Object *self, PyObject *aSlice, Py_ssize_t aLen,
-    PyObject *aValue
+// items are [key, value] entries, wrapped as (key, value) tuples
+PyObject *
+Object::Entries::__item__(
+    JSContext *aCx, int aKind, const JS::HandleValue &aValue
 )
 {
-    Py_ssize_t start, stop, slicelength;
+    PyObject *aKey = nullptr, *aItem = nullptr, *result = nullptr;
 
-    if (_PySlice_GetIndices(aSlice, aLen, &start, &stop, &slicelength)) {
-        return -1;
+    if (aKind != Items) {
+        return Wrap(aCx, aValue);
     }
     PY_ENSURE_TRUE(
-        ((start + slicelength) <= UINT32_MAX), -1,
-        PyExc_IndexError, "assignment slice out of range"
+        aValue.isObject(), nullptr, PyExc_TypeError,
+        "expected a [key, value] entry"
     );
-    if (aValue) {
-        return __setElements__(aCx, self, start, slicelength, aValue);
+    JS::RootedObject aEntry(aCx, &aValue.toObject());
+    JS::RootedValue aJSValue(aCx);
+    if (
+        JS_GetElement(aCx, aEntry, 0, &aJSValue) &&
+        (aKey = Wrap(aCx, aJSValue)) // +1
+    ) {
+        if (
+            JS_GetElement(aCx, aEntry, 1, &aJSValue) &&
+            (aItem = Wrap(aCx, aJSValue)) // +1
+        ) {
+            result = PyTuple_Pack(2, aKey, aItem); // +1
+            Py_DECREF(aItem); // -1
+        }
+        Py_DECREF(aKey); // -1
     }
-    return __delElements__(aCx, self, start, slicelength);
+    return result;
 }
 
 
-/* -------------------------------------------------------------------------- */
-
+// read the next chunk, small at first (loops often break early) then growing
+bool
+Object::Entries::__fetch__(JSContext *aCx, Entries *self)
+{
+    Py_ssize_t i;
+    PyObject *aItem = nullptr;
+
+    Py_CLEAR(self->mItems);
+    self->mPos = 0;
+    if (!self->mChunk) {
+        self->mChunk = 16;
+    }
+    JS::RootedValue aIterator(aCx, JS::ObjectValue(*self->mJSObject));
+    JS::AutoValueVector aValues(aCx);
+    if (!__read__(aCx, aIterator, self->mChunk, aValues, &self->mDone)) {
+        return false;
+    }
+    if (aValues.empty()) {
+        self->mDone = true;
+        return true;
+    }
+    if (!(self->mItems = PyTuple_New(aValues.length()))) {
+        return false;
+    }
+    for (i = 0; i < PyTuple_GET_SIZE(self->mItems); i++) {
+        if (!(aItem = __item__(aCx, self->mKind, aValues[i]))) { // +1
+            Py_CLEAR(self->mItems);
+            return false;
+        }
+        PyTuple_SET_ITEM(self->mItems, i, aItem); // -1
+    }
+    if (self->mChunk < chunkSize) {
+        self->mChunk *= 2;
+    }
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Object::Entries::Type.tp_iternext
+PyObject *
+Object::Entries::Next(Entries *self)
+{
+    PyObject *aItem = nullptr;
+
+    if (!self->mItems || (self->mPos >= PyTuple_GET_SIZE(self->mItems))) {
+        if (self->mDone) {
+            Py_CLEAR(self->mItems);
+            return nullptr;
+        }
+
+        AutoScript aes(self->mJSObject, "pyjs::Object::Entries::Next");
+        JSContext *aCx = aes.cx();
+        AutoReporter ar(aCx);
+
+        if (!__fetch__(aCx, self) || !self->mItems) {
+            return nullptr;
+        }
+    }
+    aItem = PyTuple_GET_ITEM(self->mItems, self->mPos++); // borrowed
+    Py_INCREF(aItem);
+    return aItem;
+}
+
+
+// Object::Entries::Type.tp_finalize
+void
+Object::Entries::Finalize(Entries *self)
+{
+    Py_CLEAR(self->mItems);
+    Object::Finalize(self);
+}
+
+
+// Object::Entries::Type
+PyTypeObject Object::Entries::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul::wrappers::pyjs::Object::Entries",
+    .tp_basicsize = sizeof(Object::Entries),
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_FINALIZE),
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)Object::Entries::Next,
+    .tp_finalize = (destructor)Object::Entries::Finalize,
+};
+
+
+/* public ------------------------------------------------------------------- */
+
+PyObject *
+Object::Entries::New(
+    JSContext *aCx, const JS::HandleValue &aIterator, int aKind
+)
+{
+    Entries *self = nullptr;
+
+    PY_ENSURE_TRUE(
+        aIterator.isObject(), nullptr, PyExc_TypeError,
+        "expected an iterator object"
+    );
+    JS::RootedObject aJSObject(aCx, &aIterator.toObject());
+    if ((self = (Entries *)Alloc<Object::Entries>(aCx, aJSObject, nullptr))) {
+        self->mKind = aKind;
+    }
+    return self;
+}
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::pyjs::Object::Array
+   -------------------------------------------------------------------------- */
+
+bool
+Object::Array::__check__(PyObject *aOther)
+{
+    return (
+        PySequence_Check(aOther) ||
+        PyObject_TypeCheck(aOther, &Object::Array::Type)
+    );
+}
+
+
+PyObject *
+Object::Array::__getElement__(JSContext *aCx, Object *self, uint32_t aIdx)
+{
+    JS::RootedValue aResult(aCx, JS::UndefinedValue());
+    if (!JS_GetElement(aCx, self->mJSObject, aIdx, &aResult)) {
+        return nullptr;
+    }
+    return Wrap(aCx, aResult);
+}
+
+
+// copy elements [aStart, aEnd) into aValues, dense arrays are copied
+// directly by the engine
+bool
+Object::Array::__readElements__(
+    JSContext *aCx, Object *self, uint32_t aStart, uint32_t aEnd,
+    JS::AutoValueVector &aValues
+)
+{
+    uint32_t size = (aEnd > aStart) ? (aEnd - aStart) : 0;
+
+    if (!aValues.resize(size)) {
+        PyErr_NoMemory();
+        return false;
+    }
+    if (!size) {
+        return true;
+    }
+    js::ElementAdder adder(
+        aCx, aValues.begin(), size, js::ElementAdder::GetElement
+    );
+    return js::GetElementsWithAdder(
+        aCx, self->mJSObject, self->mJSObject, aStart, aEnd, &adder
+    );
+}
+
+
+int
+Object::Array::__setElement__(
+    JSContext *aCx, Object *self, uint32_t aIdx, PyObject *aValue
+)
+{
+    JS::RootedValue aJSValue(aCx, jspy::Wrap(aCx, aValue));
+    if (
+        aJSValue.isUndefined() ||
+        !JS_SetElement(aCx, self->mJSObject, aIdx, aJSValue)
+    ) {
+        return -1;
+    }
+    return 0;
+}
+
+
+// write aValues to elements [aStart, aStart + aValues.length()) of aJSObject
+bool
+Object::Array::__writeElements__(
+    JSContext *aCx, JS::HandleObject aJSObject, uint32_t aStart,
+    JS::AutoValueVector &aValues
+)
+{
+    size_t i;
+
+    for (i = 0; i < aValues.length(); i++) {
+        if (!JS_SetElement(aCx, aJSObject, aStart + i, aValues[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// move elements [aFrom, aEnd) to aTo, a chunk at a time
+bool
+Object::Array::__moveElements__(
+    JSContext *aCx, Object *self, uint32_t aTo, uint32_t aFrom, uint32_t aEnd
+)
+{
+    uint32_t start, stop;
+
+    JS::AutoValueVector aValues(aCx);
+    if (aTo < aFrom) {
+        for (start = aFrom; start < aEnd; start = stop) {
+            stop = ((aEnd - start) > chunkSize) ? (start + chunkSize) : aEnd;
+            if (
+                !__readElements__(aCx, self, start, stop, aValues) ||
+                !__writeElements__(
+                    aCx, self->mJSObject, aTo + (start - aFrom), aValues
+                )
+            ) {
+                return false;
+            }
+        }
+    }
+    else if (aTo > aFrom) {
+        // backwards, so we don't overwrite what is left to move
+        for (stop = aEnd; stop > aFrom; stop = start) {
+            start = ((stop - aFrom) > chunkSize) ? (stop - chunkSize) : aFrom;
+            if (
+                !__readElements__(aCx, self, start, stop, aValues) ||
+                !__writeElements__(
+                    aCx, self->mJSObject, aTo + (start - aFrom), aValues
+                )
+            ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+// write aCount copies of elements [0, aLen) to aJSObject, starting at aStart,
+// a chunk at a time
+bool
+Object::Array::__repeatElements__(
+    JSContext *aCx, Object *self, uint32_t aLen, JS::HandleObject aJSObject,
+    uint32_t aStart, uint32_t aCount
+)
+{
+    uint32_t start, stop, i;
+
+    JS::AutoValueVector aValues(aCx);
+    for (start = 0; start < aLen; start = stop) {
+        stop = ((aLen - start) > chunkSize) ? (start + chunkSize) : aLen;
+        if (!__readElements__(aCx, self, start, stop, aValues)) {
+            return false;
+        }
+        for (i = 0; i < aCount; i++) {
+            if (
+                !__writeElements__(
+                    aCx, aJSObject, aStart + (i * aLen) + start, aValues
+                )
+            ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+PyObject *
+Object::Array::__getElements__(
+    JSContext *aCx, Object *self, uint32_t aStart, Py_ssize_t aStep,
+    uint32_t aCount
+)
+{
+    uint32_t i;
+
+    JS::AutoValueVector aValues(aCx);
+    if (aStep == 1) {
+        if (!__readElements__(aCx, self, aStart, aStart + aCount, aValues)) {
+            return nullptr;
+        }
+    }
+    else {
+        if (!aValues.resize(aCount)) {
+            PyErr_NoMemory();
+            return nullptr;
+        }
+        for (i = 0; i < aCount; i++) {
+            if (
+                !JS_GetElement(
+                    aCx, self->mJSObject, (uint32_t)(aStart + i * aStep),
+                    aValues[i]
+                )
+            ) {
+                return nullptr;
+            }
+        }
+    }
+    JS::RootedObject aResult(aCx, JS_NewArrayObject(aCx, aValues));
+    if (!aResult) {
+        PyErr_NoMemory();
+        return nullptr;
+    }
+    return WrapObject(aCx, &aResult);
+}
+
+
+int
+Object::Array::__setElements__(
+    JSContext *aCx, Object *self, uint32_t aStart, Py_ssize_t aStep,
+    uint32_t aCount, PyObject *aValue
+)
+{
+    Py_ssize_t aLen, aSize;
+    uint32_t i;
+
+    JS::AutoValueVector aValues(aCx);
+    if (!jspy::WrapArgs(aCx, aValue, aValues)) {
+        return -1;
+    }
+    aSize = aValues.length();
+    if (aStep != 1) {
+        PY_ENSURE_TRUE(
+            (aSize == aCount), -1, PyExc_ValueError,
+            "attempt to assign sequence of size %zd to extended slice of size %zd",
+            aSize, (Py_ssize_t)aCount
+        );
+        for (i = 0; i < aCount; i++) {
+            if (
+                !JS_SetElement(
+                    aCx, self->mJSObject, (uint32_t)(aStart + i * aStep),
+                    aValues[i]
+                )
+            ) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    if ((aLen = __len__(aCx, self)) < 0) {
+        return -1;
+    }
+    PY_ENSURE_TRUE(
+        ((aLen - aCount + aSize) <= UINT32_MAX), -1, PyExc_OverflowError,
+        "the resulting length would be too big for JavaScript"
+    );
+    // make room for (or close the gap left by) the new elements
+    if (
+        (aSize != aCount) &&
+        (
+            !__moveElements__(aCx, self, aStart + aSize, aStart + aCount, aLen) ||
+            !JS_SetArrayLength(aCx, self->mJSObject, aLen - aCount + aSize)
+        )
+    ) {
+        return -1;
+    }
+    return __writeElements__(aCx, self->mJSObject, aStart, aValues) ? 0 : -1;
+}
+
+
+int
+Object::Array::__delElements__(
+    JSContext *aCx, Object *self, uint32_t aStart, Py_ssize_t aStep,
+    uint32_t aCount
+)
+{
+    Py_ssize_t aLen;
+    uint32_t i, cur, next;
+
+    if (!aCount) {
+        return 0;
+    }
+    if ((aLen = __len__(aCx, self)) < 0) {
+        return -1;
+    }
+    if (aStep < 0) {
+        // walk the slice upwards
+        aStart = (uint32_t)(aStart + (aCount - 1) * aStep);
+        aStep = -aStep;
+    }
+    if (aStep == 1) {
+        if (!__moveElements__(aCx, self, aStart, aStart + aCount, aLen)) {
+            return -1;
+        }
+    }
+    else {
+        // close the gap left by each deleted element
+        for (i = 0; i < aCount; i++) {
+            cur = aStart + (i * aStep) + 1;
+            next = ((i + 1) < aCount) ? (cur + aStep - 1) : aLen;
+            if (!__moveElements__(aCx, self, cur - (i + 1), cur, next)) {
+                return -1;
+            }
+        }
+    }
+    return JS_SetArrayLength(aCx, self->mJSObject, aLen - aCount) ? 0 : -1;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+Py_ssize_t
+Object::Array::__len__(JSContext *aCx, Object *self)
+{
+    uint32_t aLen;
+
+    if (!JS_GetArrayLength(aCx, self->mJSObject, &aLen)) {
+        return -1;
+    }
+    return aLen;
+}
+
+
+PyObject *
+Object::Array::__getitem__(JSContext *aCx, Object *self, Py_ssize_t aIdx)
+{
+    bool found = false;
+
+    PY_ENSURE_TRUE(
+        (aIdx <= UINT32_MAX), nullptr, PyExc_OverflowError,
+        "index too big for JavaScript"
+    );
+    if (!JS_HasElement(aCx, self->mJSObject, aIdx, &found)) {
+        return nullptr;
+    }
+    PY_ENSURE_TRUE(found, nullptr, PyExc_IndexError, "index out of range");
+    return __getElement__(aCx, self, aIdx);
+}
+
+
+int
+Object::Array::__setitem__(
+    JSContext *aCx, Object *self, Py_ssize_t aIdx, PyObject *aValue
+)
+{
+    bool found = false;
+
+    PY_ENSURE_TRUE(
+        (aIdx <= UINT32_MAX), -1, PyExc_OverflowError,
+        "assignment index too big for JavaScript"
+    );
+    if (!JS_HasElement(aCx, self->mJSObject, aIdx, &found)) {
+        return -1;
+    }
+    PY_ENSURE_TRUE(found, -1, PyExc_IndexError, "assignment index out of range");
+    if (aValue) {
+        return __setElement__(aCx, self, aIdx, aValue);
+    }
+    return __delElements__(aCx, self, aIdx, 1, 1);
+}
+
+
+PyObject *
+Object::Array::__getslice__(
+    JSContext *aCx, Object *self, PyObject *aSlice, Py_ssize_t aLen
+)
+{
+    Py_ssize_t start, stop, step, slicelength;
+
+    if (
+        _PySlice_GetIndices(aSlice, aLen, &start, &stop, &step, &slicelength)
+    ) {
+        return nullptr;
+    }
+    return __getElements__(aCx, self, start, step, slicelength);
+}
+
+
+int
+Object::Array::__setslice__(
+    JSContext *aCx, Object *self, PyObject *aSlice, Py_ssize_t aLen,
+    PyObject *aValue
+)
+{
+    Py_ssize_t start, stop, step, slicelength;
+
+    if (
+        _PySlice_GetIndices(aSlice, aLen, &start, &stop, &step, &slicelength)
+    ) {
+        return -1;
+    }
+    if (aValue) {
+        return __setElements__(aCx, self, start, step, slicelength, aValue);
+    }
+    return __delElements__(aCx, self, start, step, slicelength);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
 PyObject *
 Object::Array::__compare__(Object *self, PyObject *aOther, int op)
 {
@@ -737,7 +1502,7 @@ Object::Array::__compare__(Object *self, PyObject *aOther, int op)
     PyObject *aSelfItem = nullptr, *aOtherItem = nullptr, *result = nullptr;
     int cmp;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Array::__compare__");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::__compare__");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -755,9 +1520,20 @@ Object::Array::__compare__(Object *self, PyObject *aOther, int op)
             Py_RETURN_TRUE;
         }
     }
+    JS::AutoValueVector aValues(aCx);
     for (i = 0; i < aSelfLen && i < aOtherLen; i++) {
+        // read our elements a chunk at a time
+        if (
+            !(i % chunkSize) &&
+            !__readElements__(
+                aCx, self, i, (i + chunkSize < aSelfLen) ? i + chunkSize : aSelfLen,
+                aValues
+            )
+        ) {
+            return nullptr;
+        }
         if (
-            !(aSelfItem = __getElement__(aCx, self, i)) || // +1
+            !(aSelfItem = Wrap(aCx, aValues[i % chunkSize])) || // +1
             !(aOtherItem = PySequence_GetItem(aOther, i)) || // +1
             ((cmp = PyObject_RichCompareBool(aSelfItem, aOtherItem, Py_EQ)) < 0)
         ) {
@@ -817,7 +1593,7 @@ Object::Array::__compare__(Object *self, PyObject *aOther, int op)
 Py_ssize_t
 Object::Array::Length(Object *self)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Array::Length");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::Length");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -829,19 +1605,38 @@ Object::Array::Length(Object *self)
 PyObject *
 Object::Array::Concat(Object *self, PyObject *aOther)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Array::Concat");
+    Py_ssize_t aLen;
+
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::Concat");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
-    JS::AutoValueVector aJSArgs(aCx);
-    if (!jspy::WrapArgs(aCx, aOther, aJSArgs)) {
+    JS::AutoValueVector aValues(aCx);
+    if (
+        ((aLen = __len__(aCx, self)) < 0) ||
+        !jspy::WrapArgs(aCx, aOther, aValues)
+    ) {
         return nullptr;
     }
-    JS::RootedValue aResult(aCx, JS::UndefinedValue());
-    if (!JS::Call(aCx, self->mJSObject, "concat", aJSArgs, &aResult)) {
+    PY_ENSURE_TRUE(
+        ((aLen + aValues.length()) <= UINT32_MAX), nullptr,
+        PyExc_OverflowError,
+        "the resulting length would be too big for JavaScript"
+    );
+    JS::RootedObject aResult(
+        aCx, JS_NewArrayObject(aCx, aLen + aValues.length())
+    );
+    if (!aResult) {
+        PyErr_NoMemory();
         return nullptr;
     }
-    return Wrap(aCx, aResult);
+    if (
+        !__repeatElements__(aCx, self, aLen, aResult, 0, 1) ||
+        !__writeElements__(aCx, aResult, aLen, aValues)
+    ) {
+        return nullptr;
+    }
+    return WrapObject(aCx, &aResult);
 }
 
 
@@ -849,9 +1644,9 @@ Object::Array::Concat(Object *self, PyObject *aOther)
 PyObject *
 Object::Array::Repeat(Object *self, Py_ssize_t aCount)
 {
-    Py_ssize_t aLen, i;
+    Py_ssize_t aLen = 0;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Array::Repeat");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::Repeat");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -863,26 +1658,18 @@ Object::Array::Repeat(Object *self, Py_ssize_t aCount)
             return nullptr;
         }
         PY_ENSURE_TRUE(
-            ((aCount * aLen) <= UINT32_MAX), nullptr, PyExc_OverflowError,
+            (!aLen || (aCount <= (Py_ssize_t)(UINT32_MAX / aLen))), nullptr,
+            PyExc_OverflowError,
             "the resulting length would be too big for JavaScript"
         );
     }
-    JS::RootedObject aResult(aCx, JS_NewArrayObject(aCx, 0));
+    JS::RootedObject aResult(aCx, JS_NewArrayObject(aCx, aCount * aLen));
     if (!aResult) {
         PyErr_NoMemory();
         return nullptr;
     }
-    if (aCount) {
-        JS::AutoValueVector aJSArgs(aCx);
-        if (!jspy::WrapArgs(aCx, self->mJSObject, aJSArgs)) {
-            return nullptr;
-        }
-        JS::RootedValue aIgnored(aCx, JS::UndefinedValue()); // ignored
-        for (i = 0; i < aCount; i++) {
-            if (!JS::Call(aCx, aResult, "push", aJSArgs, &aIgnored)) {
-                return nullptr;
-            }
-        }
+    if (aCount && !__repeatElements__(aCx, self, aLen, aResult, 0, aCount)) {
+        return nullptr;
     }
     return WrapObject(aCx, &aResult);
 }
@@ -892,7 +1679,7 @@ Object::Array::Repeat(Object *self, Py_ssize_t aCount)
 PyObject *
 Object::Array::GetItem(Object *self, Py_ssize_t aIdx)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Array::GetItem");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::GetItem");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -904,7 +1691,7 @@ Object::Array::GetItem(Object *self, Py_ssize_t aIdx)
 int
 Object::Array::SetItem(Object *self, Py_ssize_t aIdx, PyObject *aValue)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Array::SetItem");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::SetItem");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -916,7 +1703,7 @@ Object::Array::SetItem(Object *self, Py_ssize_t aIdx, PyObject *aValue)
 int
 Object::Array::Contains(Object *self, PyObject *aValue)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Array::Contains");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::Contains");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -943,16 +1730,28 @@ Object::Array::Contains(Object *self, PyObject *aValue)
 PyObject *
 Object::Array::InPlaceConcat(Object *self, PyObject *aOther)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Array::InPlaceConcat");
+    Py_ssize_t aLen;
+
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::InPlaceConcat");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
-    JS::AutoValueVector aJSArgs(aCx);
-    if (!jspy::WrapArgs(aCx, aOther, aJSArgs)) {
+    JS::AutoValueVector aValues(aCx);
+    if (
+        !jspy::WrapArgs(aCx, aOther, aValues) ||
+        ((aLen = __len__(aCx, self)) < 0)
+    ) {
         return nullptr;
     }
-    JS::RootedValue aIgnored(aCx, JS::UndefinedValue()); // ignored
-    if (!JS::Call(aCx, self->mJSObject, "push", aJSArgs, &aIgnored)) {
+    PY_ENSURE_TRUE(
+        ((aLen + aValues.length()) <= UINT32_MAX), nullptr,
+        PyExc_OverflowError,
+        "the resulting length would be too big for JavaScript"
+    );
+    if (
+        !JS_SetArrayLength(aCx, self->mJSObject, aLen + aValues.length()) ||
+        !__writeElements__(aCx, self->mJSObject, aLen, aValues)
+    ) {
         return nullptr;
     }
     Py_INCREF(self);
@@ -964,9 +1763,9 @@ Object::Array::InPlaceConcat(Object *self, PyObject *aOther)
 PyObject *
 Object::Array::InPlaceRepeat(Object *self, Py_ssize_t aCount)
 {
-    Py_ssize_t aLen, i;
+    Py_ssize_t aLen;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Array::InPlaceRepeat");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::InPlaceRepeat");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -978,21 +1777,20 @@ Object::Array::InPlaceRepeat(Object *self, Py_ssize_t aCount)
     }
     if (aCount > 1) {
         PY_ENSURE_TRUE(
-            ((aCount * aLen) <= UINT32_MAX), nullptr, PyExc_OverflowError,
+            (!aLen || (aCount <= (Py_ssize_t)(UINT32_MAX / aLen))), nullptr,
+            PyExc_OverflowError,
             "the resulting length would be too big for JavaScript"
         );
-        JS::AutoValueVector aJSArgs(aCx);
-        if (!jspy::WrapArgs(aCx, self->mJSObject, aJSArgs)) {
+        if (
+            !JS_SetArrayLength(aCx, self->mJSObject, aCount * aLen) ||
+            !__repeatElements__(
+                aCx, self, aLen, self->mJSObject, aLen, aCount - 1
+            )
+        ) {
             return nullptr;
         }
-        JS::RootedValue aIgnored(aCx, JS::UndefinedValue()); // ignored
-        for (i = 1; i < aCount; i++) {
-            if (!JS::Call(aCx, self->mJSObject, "push", aJSArgs, &aIgnored)) {
-                return nullptr;
-            }
-        }
     }
-    else if (aCount == 0 && __delElements__(aCx, self, 0, aLen)) {
+    else if (aCount == 0 && __delElements__(aCx, self, 0, 1, aLen)) {
         return nullptr;
     }
     Py_INCREF(self);
@@ -1019,7 +1817,7 @@ Object::Array::GetSlice(Object *self, PyObject *aSlice)
 {
     Py_ssize_t aLen, aIdx;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Array::GetSlice");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::GetSlice");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -1046,7 +1844,7 @@ Object::Array::SetSlice(Object *self, PyObject *aSlice, PyObject *aValue)
 {
     Py_ssize_t aLen, aIdx;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Array::SetSlice");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::SetSlice");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -1085,6 +1883,18 @@ Object::Array::RichCompare(Object *self, PyObject *aOther, int op)
 }
 
 
+// Object::Array::Type.tp_iter
+PyObject *
+Object::Array::Iter(Object *self)
+{
+    AutoScript aes(self->mJSObject, "pyjs::Object::Array::Iter");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    return Alloc<Object::Array::Iterator>(aCx, self->mJSObject, nullptr);
+}
+
+
 // Object::Array::Type
 PyTypeObject Object::Array::Type = {
     PyVarObject_HEAD_INIT(nullptr, 0)
@@ -1094,6 +1904,102 @@ PyTypeObject Object::Array::Type = {
     .tp_as_mapping = &Object::Array::AsMapping,
     .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_FINALIZE),
     .tp_richcompare = (richcmpfunc)Object::Array::RichCompare,
+    .tp_iter = (getiterfunc)Object::Array::Iter,
+};
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::pyjs::Object::Array::Iterator
+   -------------------------------------------------------------------------- */
+
+// read the next chunk, small at first (loops often break early) then growing
+bool
+Object::Array::Iterator::__fetch__(JSContext *aCx, Iterator *self)
+{
+    Py_ssize_t aLen, i;
+    uint32_t aEnd;
+    PyObject *aItem = nullptr;
+
+    Py_CLEAR(self->mItems);
+    self->mPos = 0;
+    if ((aLen = __len__(aCx, self)) < 0) {
+        return false;
+    }
+    if (self->mIndex >= aLen) {
+        self->mDone = true;
+        return true;
+    }
+    if (!self->mChunk) {
+        self->mChunk = 16;
+    }
+    aEnd = ((aLen - self->mIndex) > self->mChunk) ?
+        (self->mIndex + self->mChunk) : aLen;
+    JS::AutoValueVector aValues(aCx);
+    if (!__readElements__(aCx, self, self->mIndex, aEnd, aValues)) {
+        return false;
+    }
+    if (!(self->mItems = PyTuple_New(aValues.length()))) {
+        return false;
+    }
+    for (i = 0; i < PyTuple_GET_SIZE(self->mItems); i++) {
+        if (!(aItem = Wrap(aCx, aValues[i]))) { // +1
+            Py_CLEAR(self->mItems);
+            return false;
+        }
+        PyTuple_SET_ITEM(self->mItems, i, aItem); // -1
+    }
+    self->mIndex = aEnd;
+    if (self->mChunk < chunkSize) {
+        self->mChunk *= 2;
+    }
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Object::Array::Iterator::Type.tp_iternext
+PyObject *
+Object::Array::Iterator::Next(Iterator *self)
+{
+    PyObject *aItem = nullptr;
+
+    if (self->mDone) {
+        return nullptr;
+    }
+    if (!self->mItems || (self->mPos >= PyTuple_GET_SIZE(self->mItems))) {
+        AutoScript aes(self->mJSObject, "pyjs::Object::Array::Iterator::Next");
+        JSContext *aCx = aes.cx();
+        AutoReporter ar(aCx);
+
+        if (!__fetch__(aCx, self) || self->mDone) {
+            return nullptr;
+        }
+    }
+    aItem = PyTuple_GET_ITEM(self->mItems, self->mPos++); // borrowed
+    Py_INCREF(aItem);
+    return aItem;
+}
+
+
+// Object::Array::Iterator::Type.tp_finalize
+void
+Object::Array::Iterator::Finalize(Iterator *self)
+{
+    Py_CLEAR(self->mItems);
+    Object::Finalize(self);
+}
+
+
+// Object::Array::Iterator::Type
+PyTypeObject Object::Array::Iterator::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul::wrappers::pyjs::Object::Array::Iterator",
+    .tp_basicsize = sizeof(Object::Array::Iterator),
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_FINALIZE),
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)Object::Array::Iterator::Next,
+    .tp_finalize = (destructor)Object::Array::Iterator::Finalize,
 };
 
 
@@ -1120,6 +2026,22 @@ Object::Map::__iter__(JSContext* aCx, Object *self, JS::MutableHandleValue aResu
 }
 
 
+bool
+Object::Map::__entries__(
+    JSContext* aCx, Object *self, int aKind, JS::MutableHandleValue aResult
+)
+{
+    switch (aKind) {
+        case Entries::Keys:
+            return JS::MapKeys(aCx, self->mJSObject, aResult);
+        case Entries::Values:
+            return JS::MapValues(aCx, self->mJSObject, aResult);
+        default:
+            return JS::MapEntries(aCx, self->mJSObject, aResult);
+    }
+}
+
+
 PyObject *
 Object::Map::__getitem__(JSContext *aCx, Object *self, PyObject *aKey)
 {
@@ -1181,59 +2103,56 @@ int
 Object::Map::__eq__(JSContext *aCx, Object *self, PyObject *aOther)
 {
     Py_ssize_t size = -1;
+    size_t i;
+    PyObject *aSelfItem = nullptr, *aSelfKey = nullptr, *aOtherValue = nullptr;
+    bool done = false;
+    int eq = 1;
+
     if ((size = PyMapping_Size(aOther)) < 0) {
         return -1;
     }
     if (size != JS::MapSize(aCx, self->mJSObject)) {
         return 0;
     }
-    JS::RootedValue aIterable(aCx, JS::ObjectValue(*self->mJSObject));
-    JS::ForOfIterator aIterator(aCx);
-    if (!aIterator.init(aIterable)) {
+    JS::RootedValue aIterator(aCx);
+    if (!__entries__(aCx, self, Entries::Items, &aIterator)) {
         return -1;
     }
-    PyObject *aSelfEntry = nullptr, *aSelfItem = nullptr;
-    PyObject *aSelfKey = nullptr, *aOtherValue = nullptr;
-    JS::RootedValue aEntry(aCx);
-    bool done = false;
-    int eq;
-    while (true) {
-        if (!aIterator.next(&aEntry, &done)) {
-            return -1;
-        }
-        if (done) {
-            break;
-        }
-        if (!(aSelfEntry = Wrap(aCx, aEntry))) { // +1
+    // compare a chunk of entries at a time
+    JS::AutoValueVector aEntries(aCx);
+    while ((eq > 0) && !done) {
+        if (!Entries::__read__(aCx, aIterator, chunkSize, aEntries, &done)) {
             return -1;
         }
-        if (!(aSelfItem = _PySequence_Fast(aSelfEntry, "expected a sequence", 2))) { // +1
-            Py_DECREF(aSelfEntry); // -1
-            return -1;
-        }
-        aSelfKey = PySequence_Fast_GET_ITEM(aSelfItem, 0); // borrowed key
-        if (!PyMapping_HasKey(aOther, aSelfKey)) {
-            Py_DECREF(aSelfItem); // -1
-            Py_DECREF(aSelfEntry); // -1
-            return 0;
-        }
-        if (!(aOtherValue = PyObject_GetItem(aOther, aSelfKey))) { // +1
+        for (i = 0; (eq > 0) && (i < aEntries.length()); i++) {
+            aSelfItem = Entries::__item__(aCx, Entries::Items, aEntries[i]); // +1
+            if (!aSelfItem) {
+                return -1;
+            }
+            aSelfKey = PyTuple_GET_ITEM(aSelfItem, 0); // borrowed
+            if (PyDict_Check(aOther)) {
+                aOtherValue = PyDict_GetItemWithError(aOther, aSelfKey); // borrowed
+                Py_XINCREF(aOtherValue); // +1
+            }
+            else if (
+                !(aOtherValue = PyObject_GetItem(aOther, aSelfKey)) && // +1
+                PyErr_ExceptionMatches(PyExc_KeyError)
+            ) {
+                PyErr_Clear();
+            }
+            if (aOtherValue) {
+                eq = PyObject_RichCompareBool(
+                    PyTuple_GET_ITEM(aSelfItem, 1), aOtherValue, Py_EQ
+                );
+                Py_DECREF(aOtherValue); // -1
+            }
+            else {
+                eq = PyErr_Occurred() ? -1 : 0;
+            }
             Py_DECREF(aSelfItem); // -1
-            Py_DECREF(aSelfEntry); // -1
-            return -1;
-        }
-        eq = PyObject_RichCompareBool(
-            PySequence_Fast_GET_ITEM(aSelfItem, 1), // borrowed value
-            aOtherValue, Py_EQ
-        );
-        Py_DECREF(aOtherValue); // -1
-        Py_DECREF(aSelfItem); // -1
-        Py_DECREF(aSelfEntry); // -1
-        if (eq <= 0) {
-            return eq;
         }
     }
-    return 1;
+    return eq;
 }
 
 
@@ -1242,7 +2161,7 @@ Object::Map::__compare__(Object *self, PyObject *aOther, int op)
 {
     int eq = -1;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Map::__compare__");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Map::__compare__");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -1270,104 +2189,306 @@ Object::Map::__compare__(Object *self, PyObject *aOther, int op)
 }
 
 
-/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+// Object::Map::AsSequence.sq_contains
+int
+Object::Map::Contains(Object *self, PyObject *aKey)
+{
+    bool found = false;
+
+    AutoScript aes(self->mJSObject, "pyjs::Object::Map::Contains");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    JS::RootedValue aJSKey(aCx, jspy::Wrap(aCx, aKey));
+    if (
+        aJSKey.isUndefined() ||
+        !JS::MapHas(aCx, self->mJSObject, aJSKey, &found)
+    ) {
+        return -1;
+    }
+    return found;
+}
+
+
+// Object::Map::Type.tp_as_sequence
+PySequenceMethods Object::Map::AsSequence = {
+    .sq_contains = (objobjproc)Object::Map::Contains,
+};
+
+
+// Object::Map::AsMapping.mp_length
+Py_ssize_t
+Object::Map::Length(Object *self)
+{
+    AutoScript aes(self->mJSObject, "pyjs::Object::Map::Length");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    return JS::MapSize(aCx, self->mJSObject);
+}
+
+
+// Object::Map::AsMapping.mp_subscript
+PyObject *
+Object::Map::GetItem(Object *self, PyObject *aKey)
+{
+    AutoScript aes(self->mJSObject, "pyjs::Object::Map::GetItem");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    return __getitem__(aCx, self, aKey);
+}
+
+
+// Object::Map::AsMapping.mp_ass_subscript
+int
+Object::Map::SetItem(Object *self, PyObject *aKey, PyObject *aValue)
+{
+    AutoScript aes(self->mJSObject, "pyjs::Object::Map::SetItem");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    if (aValue) {
+        return __setitem__(aCx, self, aKey, aValue);
+    }
+    return __delitem__(aCx, self, aKey);
+}
+
+
+// Object::Map::Type.tp_as_mapping
+PyMappingMethods Object::Map::AsMapping = {
+    .mp_length = (lenfunc)Object::Map::Length,
+    .mp_subscript = (binaryfunc)Object::Map::GetItem,
+    .mp_ass_subscript = (objobjargproc)Object::Map::SetItem,
+};
+
+
+// Object::Map::Type.tp_richcompare
+PyObject *
+Object::Map::RichCompare(Object *self, PyObject *aOther, int op)
+{
+    if (__check__(aOther)) {
+        return __compare__(self, aOther, op);
+    }
+    return Object::RichCompare(self, aOther, op);
+}
+
+
+// Object::Map::Type.tp_getattro
+// our methods shadow Map.prototype.keys() and Map.prototype.values()
+PyObject *
+Object::Map::GetAttrO(Object *self, PyObject *aName)
+{
+    if (PyDict_GetItemWithError(Object::Map::Type.tp_dict, aName)) { // borrowed
+        return PyObject_GenericGetAttr(self, aName);
+    }
+    if (PyErr_Occurred()) {
+        return nullptr;
+    }
+    return Object::GetAttrO(self, aName);
+}
+
+
+// Object::Map::Type.tp_iter
+PyObject *
+Object::Map::Iter(Object *self)
+{
+    AutoScript aes(self->mJSObject, "pyjs::Object::Map::Iter");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    JS::RootedValue aIterator(aCx);
+    if (!__entries__(aCx, self, Entries::Keys, &aIterator)) {
+        return nullptr;
+    }
+    return Entries::New(aCx, aIterator, Entries::Keys);
+}
+
+
+// Object::Map.keys()
+PyObject *
+Object::Map::Keys(Object *self)
+{
+    return View::New(self, Entries::Keys);
+}
+
+
+// Object::Map.values()
+PyObject *
+Object::Map::Values(Object *self)
+{
+    return View::New(self, Entries::Values);
+}
+
+
+// Object::Map.items()
+PyObject *
+Object::Map::Items(Object *self)
+{
+    return View::New(self, Entries::Items);
+}
+
+
+// Object::Map::Type.tp_methods
+PyMethodDef Object::Map::Methods[] = {
+    {"keys", (PyCFunction)Object::Map::Keys, METH_NOARGS, nullptr},
+    {"values", (PyCFunction)Object::Map::Values, METH_NOARGS, nullptr},
+    {"items", (PyCFunction)Object::Map::Items, METH_NOARGS, nullptr},
+    {nullptr} /* Sentinel */
+};
+
+
+// Object::Map::Type
+PyTypeObject Object::Map::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul::wrappers::pyjs::Object::Map",
+    .tp_basicsize = sizeof(Object),
+    .tp_as_sequence = &Object::Map::AsSequence,
+    .tp_as_mapping = &Object::Map::AsMapping,
+    .tp_getattro = (getattrofunc)Object::Map::GetAttrO,
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_FINALIZE),
+    .tp_richcompare = (richcmpfunc)Object::Map::RichCompare,
+    .tp_iter = (getiterfunc)Object::Map::Iter,
+    .tp_methods = Object::Map::Methods,
+};
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::pyjs::Object::Map::View
+   -------------------------------------------------------------------------- */
 
-// Object::Map::AsSequence.sq_contains
 int
-Object::Map::Contains(Object *self, PyObject *aKey)
+Object::Map::View::__contains__(JSContext *aCx, View *self, PyObject *aValue)
 {
-    bool found = false;
-
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Map::Contains");
-    JSContext *aCx = aes.cx();
-    AutoReporter ar(aCx);
+    PyObject *aItem = nullptr;
+    bool found = false, done = false;
+    size_t i;
+    int res = 0;
 
-    JS::RootedValue aJSKey(aCx, jspy::Wrap(aCx, aKey));
-    if (
-        aJSKey.isUndefined() ||
-        !JS::MapHas(aCx, self->mJSObject, aJSKey, &found)
-    ) {
+    if (self->mKind == Entries::Keys) {
+        return Map::Contains(self, aValue);
+    }
+    if (self->mKind == Entries::Items) {
+        if (!PyTuple_Check(aValue) || (PyTuple_GET_SIZE(aValue) != 2)) {
+            return 0;
+        }
+        JS::RootedValue aJSKey(
+            aCx, jspy::Wrap(aCx, PyTuple_GET_ITEM(aValue, 0))
+        );
+        if (
+            aJSKey.isUndefined() ||
+            !JS::MapHas(aCx, self->mJSObject, aJSKey, &found)
+        ) {
+            return -1;
+        }
+        if (!found) {
+            return 0;
+        }
+        if (!(aItem = __getitem__(aCx, self, PyTuple_GET_ITEM(aValue, 0)))) { // +1
+            return -1;
+        }
+        res = PyObject_RichCompareBool(aItem, PyTuple_GET_ITEM(aValue, 1), Py_EQ);
+        Py_DECREF(aItem); // -1
+        return res;
+    }
+    // values, scan a chunk at a time
+    JS::RootedValue aIterator(aCx);
+    if (!__entries__(aCx, self, Entries::Values, &aIterator)) {
         return -1;
     }
-    return found;
+    JS::AutoValueVector aValues(aCx);
+    while (!res && !done) {
+        if (!Entries::__read__(aCx, aIterator, chunkSize, aValues, &done)) {
+            return -1;
+        }
+        for (i = 0; !res && (i < aValues.length()); i++) {
+            if (!(aItem = Wrap(aCx, aValues[i]))) { // +1
+                return -1;
+            }
+            res = PyObject_RichCompareBool(aItem, aValue, Py_EQ);
+            Py_DECREF(aItem); // -1
+        }
+    }
+    return res;
 }
 
 
-// Object::Map::Type.tp_as_sequence
-PySequenceMethods Object::Map::AsSequence = {
-    .sq_contains = (objobjproc)Object::Map::Contains,
-};
-
+/* -------------------------------------------------------------------------- */
 
-// Object::Map::AsMapping.mp_length
+// Object::Map::View::AsSequence.sq_length
 Py_ssize_t
-Object::Map::Length(Object *self)
+Object::Map::View::Length(View *self)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Map::Length");
-    JSContext *aCx = aes.cx();
-    AutoReporter ar(aCx);
-
-    return JS::MapSize(aCx, self->mJSObject);
+    return Map::Length(self);
 }
 
 
-// Object::Map::AsMapping.mp_subscript
-PyObject *
-Object::Map::GetItem(Object *self, PyObject *aKey)
+// Object::Map::View::AsSequence.sq_contains
+int
+Object::Map::View::Contains(View *self, PyObject *aValue)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Map::GetItem");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Map::View::Contains");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
-    return __getitem__(aCx, self, aKey);
+    return __contains__(aCx, self, aValue);
 }
 
 
-// Object::Map::AsMapping.mp_ass_subscript
-int
-Object::Map::SetItem(Object *self, PyObject *aKey, PyObject *aValue)
+// Object::Map::View::Type.tp_as_sequence
+PySequenceMethods Object::Map::View::AsSequence = {
+    .sq_length = (lenfunc)Object::Map::View::Length,
+    .sq_contains = (objobjproc)Object::Map::View::Contains,
+};
+
+
+// Object::Map::View::Type.tp_iter
+PyObject *
+Object::Map::View::Iter(View *self)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Map::SetItem");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Map::View::Iter");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
-    if (aValue) {
-        return __setitem__(aCx, self, aKey, aValue);
+    JS::RootedValue aIterator(aCx);
+    if (!__entries__(aCx, self, self->mKind, &aIterator)) {
+        return nullptr;
     }
-    return __delitem__(aCx, self, aKey);
+    return Entries::New(aCx, aIterator, self->mKind);
 }
 
 
-// Object::Map::Type.tp_as_mapping
-PyMappingMethods Object::Map::AsMapping = {
-    .mp_length = (lenfunc)Object::Map::Length,
-    .mp_subscript = (binaryfunc)Object::Map::GetItem,
-    .mp_ass_subscript = (objobjargproc)Object::Map::SetItem,
+// Object::Map::View::Type
+PyTypeObject Object::Map::View::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul::wrappers::pyjs::Object::Map::View",
+    .tp_basicsize = sizeof(Object::Map::View),
+    .tp_as_sequence = &Object::Map::View::AsSequence,
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_FINALIZE),
+    .tp_iter = (getiterfunc)Object::Map::View::Iter,
 };
 
 
-// Object::Map::Type.tp_richcompare
+/* public ------------------------------------------------------------------- */
+
 PyObject *
-Object::Map::RichCompare(Object *self, PyObject *aOther, int op)
+Object::Map::View::New(Object *aMap, int aKind)
 {
-    if (__check__(aOther)) {
-        return __compare__(self, aOther, op);
-    }
-    return Object::RichCompare(self, aOther, op);
-}
+    View *self = nullptr;
 
+    AutoScript aes(aMap->mJSObject, "pyjs::Object::Map::View::New");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
 
-// Object::Map::Type
-PyTypeObject Object::Map::Type = {
-    PyVarObject_HEAD_INIT(nullptr, 0)
-    .tp_name = "pyxul::wrappers::pyjs::Object::Map",
-    .tp_basicsize = sizeof(Object),
-    .tp_as_sequence = &Object::Map::AsSequence,
-    .tp_as_mapping = &Object::Map::AsMapping,
-    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_FINALIZE),
-    .tp_richcompare = (richcmpfunc)Object::Map::RichCompare,
-    .tp_iter = (getiterfunc)Object::Iter<Object::Map>,
-};
+    if (
+        (self = (View *)Alloc<Object::Map::View>(aCx, aMap->mJSObject, nullptr))
+    ) {
+        self->mKind = aKind;
+    }
+    return self;
+}
 
 
 /* --------------------------------------------------------------------------
@@ -1384,28 +2505,70 @@ Object::Set::__check__(PyObject *aOther)
 }
 
 
+// aOther as a JS Set, Python elements are wrapped once
+bool
+Object::Set::__set__(
+    JSContext *aCx, PyObject *aOther, JS::MutableHandleObject aResult
+)
+{
+    PyObject *aIter = nullptr, *aValue = nullptr;
+
+    if (PyObject_TypeCheck(aOther, &Object::Set::Type)) {
+        aResult.set(((Object *)aOther)->mJSObject);
+        return JS_WrapObject(aCx, aResult);
+    }
+    aResult.set(JS::NewSetObject(aCx));
+    if (!aResult) {
+        return false;
+    }
+    if (!(aIter = PyObject_GetIter(aOther))) { // +1
+        return false;
+    }
+    JS::RootedValue aJSValue(aCx, JS::UndefinedValue());
+    while ((aValue = PyIter_Next(aIter))) { // +1
+        aJSValue.set(jspy::Wrap(aCx, aValue));
+        Py_DECREF(aValue); // -1
+        if (aJSValue.isUndefined() || !JS::SetAdd(aCx, aResult, aJSValue)) {
+            Py_DECREF(aIter); // -1
+            return false;
+        }
+    }
+    Py_DECREF(aIter); // -1
+    return !PyErr_Occurred();
+}
+
+
+// all the values of aSet, read at once
+bool
+Object::Set::__values__(
+    JSContext *aCx, JS::HandleObject aSet, JS::AutoValueVector &aValues
+)
+{
+    bool done = false;
+
+    JS::RootedValue aIterator(aCx);
+    return (
+        JS::SetValues(aCx, aSet, &aIterator) &&
+        Entries::__read__(aCx, aIterator, UINT32_MAX, aValues, &done)
+    );
+}
+
+
 JSObject *
 Object::Set::__copy__(JSContext *aCx, Object *self)
 {
+    size_t i;
+
     JS::RootedObject aResult(aCx, JS::NewSetObject(aCx));
     if (!aResult) {
         return nullptr;
     }
-    JS::RootedValue aIterable(aCx, JS::ObjectValue(*self->mJSObject));
-    JS::ForOfIterator aIterator(aCx);
-    if (!aIterator.init(aIterable)) {
+    JS::AutoValueVector aValues(aCx);
+    if (!__values__(aCx, self->mJSObject, aValues)) {
         return nullptr;
     }
-    JS::RootedValue aJSValue(aCx);
-    bool done = false;
-    while (true) {
-        if (!aIterator.next(&aJSValue, &done)) {
-            return nullptr;
-        }
-        if (done) {
-            break;
-        }
-        if (!JS::SetAdd(aCx, aResult, aJSValue)) {
+    for (i = 0; i < aValues.length(); i++) {
+        if (!JS::SetAdd(aCx, aResult, aValues[i])) {
             return nullptr;
         }
     }
@@ -1422,38 +2585,41 @@ Object::Set::__iter__(JSContext* aCx, Object *self, JS::MutableHandleValue aResu
 }
 
 
+// set kernels, aOther and aResult are both JS Sets
+
 int
 Object::Set::__sub__(
-    JSContext *aCx, PyObject *aOther, JS::MutableHandleObject aResult
+    JSContext *aCx, JS::HandleObject aOther, JS::MutableHandleObject aResult
 )
 {
-    PyObject *aIter = nullptr, *aValue = nullptr;
-    bool ignored;
+    size_t i;
+    bool found;
 
-    PY_ENSURE_TRUE(
-        __check__(aOther), -1, PyExc_TypeError,
-        "unsupported operand type(s) for -: 'Set' and '%s'",
-        Py_TYPE(aOther)->tp_name
-    );
-    if (!(aIter = PyObject_GetIter(aOther))) { // +1
-        return -1;
-    }
-    JS::RootedValue aJSValue(aCx, JS::UndefinedValue());
-    while ((aValue = PyIter_Next(aIter))) { // +1
-        aJSValue.set(jspy::Wrap(aCx, aValue));
-        if (
-            aJSValue.isUndefined() ||
-            !JS::SetDelete(aCx, aResult, aJSValue, &ignored)
-        ) {
-            Py_DECREF(aValue); // -1
-            Py_DECREF(aIter); // -1
+    JS::AutoValueVector aValues(aCx);
+    // walk the smaller set
+    if (JS::SetSize(aCx, aOther) <= JS::SetSize(aCx, aResult)) {
+        if (!__values__(aCx, aOther, aValues)) {
             return -1;
         }
-        Py_DECREF(aValue); // -1
+        for (i = 0; i < aValues.length(); i++) {
+            if (!JS::SetDelete(aCx, aResult, aValues[i], &found)) {
+                return -1;
+            }
+        }
     }
-    Py_DECREF(aIter); // -1
-    if (PyErr_Occurred()) {
-        return -1;
+    else {
+        if (!__values__(aCx, aResult, aValues)) {
+            return -1;
+        }
+        for (i = 0; i < aValues.length(); i++) {
+            found = false;
+            if (
+                !JS::SetHas(aCx, aOther, aValues[i], &found) ||
+                (found && !JS::SetDelete(aCx, aResult, aValues[i], &found))
+            ) {
+                return -1;
+            }
+        }
     }
     return 0;
 }
@@ -1461,46 +2627,35 @@ Object::Set::__sub__(
 
 int
 Object::Set::__and__(
-    JSContext *aCx, PyObject *aOther, JS::MutableHandleObject aResult
+    JSContext *aCx, JS::HandleObject aOther, JS::MutableHandleObject aResult
 )
 {
-    PyObject *aIter = nullptr, *aValue = nullptr;
+    size_t i;
     bool found;
 
-    PY_ENSURE_TRUE(
-        __check__(aOther), -1, PyExc_TypeError,
-        "unsupported operand type(s) for &: 'Set' and '%s'",
-        Py_TYPE(aOther)->tp_name
-    );
     JS::RootedObject result(aCx, JS::NewSetObject(aCx));
     if (!result) {
         return -1;
     }
-    if (!(aIter = PyObject_GetIter(aOther))) { // +1
+    // walk the smaller set, look into the other one
+    JS::RootedObject aSmall(aCx, aResult), aLarge(aCx, aOther);
+    if (JS::SetSize(aCx, aOther) < JS::SetSize(aCx, aResult)) {
+        aSmall.set(aOther);
+        aLarge.set(aResult);
+    }
+    JS::AutoValueVector aValues(aCx);
+    if (!__values__(aCx, aSmall, aValues)) {
         return -1;
     }
-    JS::RootedValue aJSValue(aCx, JS::UndefinedValue());
-    while ((aValue = PyIter_Next(aIter))) { // +1
+    for (i = 0; i < aValues.length(); i++) {
         found = false;
-        aJSValue.set(jspy::Wrap(aCx, aValue));
         if (
-            aJSValue.isUndefined() ||
-            !JS::SetHas(aCx, aResult, aJSValue, &found)
+            !JS::SetHas(aCx, aLarge, aValues[i], &found) ||
+            (found && !JS::SetAdd(aCx, result, aValues[i]))
         ) {
-            Py_DECREF(aValue); // -1
-            Py_DECREF(aIter); // -1
-            return -1;
-        }
-        Py_DECREF(aValue); // -1
-        if (found && !JS::SetAdd(aCx, result, aJSValue)) {
-            Py_DECREF(aIter); // -1
             return -1;
         }
     }
-    Py_DECREF(aIter); // -1
-    if (PyErr_Occurred()) {
-        return -1;
-    }
     aResult.set(result);
     return 0;
 }
@@ -1508,166 +2663,109 @@ Object::Set::__and__(
 
 int
 Object::Set::__xor__(
-    JSContext *aCx, PyObject *aOther, JS::MutableHandleObject aResult
+    JSContext *aCx, JS::HandleObject aOther, JS::MutableHandleObject aResult
 )
 {
-    PyObject *aIter = nullptr, *aValue = nullptr;
+    size_t i;
     bool found;
 
-    PY_ENSURE_TRUE(
-        __check__(aOther), -1, PyExc_TypeError,
-        "unsupported operand type(s) for ^: 'Set' and '%s'",
-        Py_TYPE(aOther)->tp_name
-    );
-    if (!(aIter = PyObject_GetIter(aOther))) { // +1
+    JS::AutoValueVector aValues(aCx);
+    if (!__values__(aCx, aOther, aValues)) {
         return -1;
     }
-    JS::RootedValue aJSValue(aCx, JS::UndefinedValue());
-    while ((aValue = PyIter_Next(aIter))) { // +1
+    for (i = 0; i < aValues.length(); i++) {
         found = true;
-        aJSValue.set(jspy::Wrap(aCx, aValue));
         if (
-            aJSValue.isUndefined() ||
-            !JS::SetDelete(aCx, aResult, aJSValue, &found)
+            !JS::SetDelete(aCx, aResult, aValues[i], &found) ||
+            (!found && !JS::SetAdd(aCx, aResult, aValues[i]))
         ) {
-            Py_DECREF(aValue); // -1
-            Py_DECREF(aIter); // -1
-            return -1;
-        }
-        Py_DECREF(aValue); // -1
-        if (!found && !JS::SetAdd(aCx, aResult, aJSValue)) {
-            Py_DECREF(aIter); // -1
             return -1;
         }
     }
-    Py_DECREF(aIter); // -1
-    if (PyErr_Occurred()) {
-        return -1;
-    }
     return 0;
 }
 
 
 int
 Object::Set::__or__(
-    JSContext *aCx, PyObject *aOther, JS::MutableHandleObject aResult
+    JSContext *aCx, JS::HandleObject aOther, JS::MutableHandleObject aResult
 )
 {
-    PyObject *aIter = nullptr, *aValue = nullptr;
+    size_t i;
 
-    PY_ENSURE_TRUE(
-        __check__(aOther), -1, PyExc_TypeError,
-        "unsupported operand type(s) for |: 'Set' and '%s'",
-        Py_TYPE(aOther)->tp_name
-    );
-    if (!(aIter = PyObject_GetIter(aOther))) { // +1
+    JS::AutoValueVector aValues(aCx);
+    if (!__values__(aCx, aOther, aValues)) {
         return -1;
     }
-    JS::RootedValue aJSValue(aCx, JS::UndefinedValue());
-    while ((aValue = PyIter_Next(aIter))) { // +1
-        aJSValue.set(jspy::Wrap(aCx, aValue));
-        if (
-            aJSValue.isUndefined() ||
-            !JS::SetAdd(aCx, aResult, aJSValue)
-        ) {
-            Py_DECREF(aValue); // -1
-            Py_DECREF(aIter); // -1
+    for (i = 0; i < aValues.length(); i++) {
+        if (!JS::SetAdd(aCx, aResult, aValues[i])) {
             return -1;
         }
-        Py_DECREF(aValue); // -1
-    }
-    Py_DECREF(aIter); // -1
-    if (PyErr_Occurred()) {
-        return -1;
     }
     return 0;
 }
 
 
-/* -------------------------------------------------------------------------- */
-
-PyObject *
-Object::Set::__le__(JSContext *aCx, Object *self, PyObject *aOther)
+// is every value of aSet in aOther
+int
+Object::Set::__in__(
+    JSContext *aCx, JS::HandleObject aSet, JS::HandleObject aOther
+)
 {
-    Py_ssize_t size = -1;
-    PyObject *aValue = nullptr;
-    int found;
+    size_t i;
+    bool found;
 
-    if ((size = PySequence_Size(aOther)) < 0) {
-        return nullptr;
-    }
-    if (size < JS::SetSize(aCx, self->mJSObject)) {
-        Py_RETURN_FALSE;
-    }
-    JS::RootedValue aIterable(aCx, JS::ObjectValue(*self->mJSObject));
-    JS::ForOfIterator aIterator(aCx);
-    if (!aIterator.init(aIterable)) {
-        return nullptr;
+    if (JS::SetSize(aCx, aSet) > JS::SetSize(aCx, aOther)) {
+        return 0;
     }
-    JS::RootedValue aJSValue(aCx);
-    bool done = false;
-    while (true) {
-        if (!aIterator.next(&aJSValue, &done)) {
-            return nullptr;
-        }
-        if (done) {
-            break;
-        }
-        if (!(aValue = Wrap(aCx, aJSValue))) { // +1
-            return nullptr;
-        }
-        if ((found = PySequence_Contains(aOther, aValue)) < 0) {
-            Py_DECREF(aValue); // -1
-            return nullptr;
+    JS::AutoValueVector aValues(aCx);
+    if (!__values__(aCx, aSet, aValues)) {
+        return -1;
+    }
+    for (i = 0; i < aValues.length(); i++) {
+        found = false;
+        if (!JS::SetHas(aCx, aOther, aValues[i], &found)) {
+            return -1;
         }
-        Py_DECREF(aValue); // -1
         if (!found) {
-            Py_RETURN_FALSE;
+            return 0;
         }
     }
-    Py_RETURN_TRUE;
+    return 1;
 }
 
 
+/* -------------------------------------------------------------------------- */
+
 PyObject *
-Object::Set::__ge__(JSContext *aCx, Object *self, PyObject *aOther)
+Object::Set::__le__(JSContext *aCx, Object *self, PyObject *aOther)
 {
-    Py_ssize_t size = -1;
-    PyObject *aIter = nullptr, *aValue = nullptr;
-    bool found;
+    int res = -1;
 
-    if ((size = PySequence_Size(aOther)) < 0) {
-        return nullptr;
-    }
-    if (size > JS::SetSize(aCx, self->mJSObject)) {
-        Py_RETURN_FALSE;
-    }
-    if (!(aIter = PyObject_GetIter(aOther))) { // +1
+    JS::RootedObject aOtherSet(aCx);
+    if (
+        !__set__(aCx, aOther, &aOtherSet) ||
+        ((res = __in__(aCx, self->mJSObject, aOtherSet)) < 0)
+    ) {
         return nullptr;
     }
-    JS::RootedValue aJSValue(aCx, JS::UndefinedValue());
-    while ((aValue = PyIter_Next(aIter))) { // +1
-        found = true;
-        aJSValue.set(jspy::Wrap(aCx, aValue));
-        if (
-            aJSValue.isUndefined() ||
-            !JS::SetHas(aCx, self->mJSObject, aJSValue, &found)
-        ) {
-            Py_DECREF(aValue); // -1
-            Py_DECREF(aIter); // -1
-            return nullptr;
-        }
-        Py_DECREF(aValue); // -1
-        if (!found) {
-            Py_DECREF(aIter); // -1
-            Py_RETURN_FALSE;
-        }
-    }
-    Py_DECREF(aIter); // -1
-    if (PyErr_Occurred()) {
+    return PyBool_FromLong(res);
+}
+
+
+PyObject *
+Object::Set::__ge__(JSContext *aCx, Object *self, PyObject *aOther)
+{
+    int res = -1;
+
+    JS::RootedObject aOtherSet(aCx);
+    if (
+        !__set__(aCx, aOther, &aOtherSet) ||
+        ((res = __in__(aCx, aOtherSet, self->mJSObject)) < 0)
+    ) {
         return nullptr;
     }
-    Py_RETURN_TRUE;
+    return PyBool_FromLong(res);
 }
 
 
@@ -1677,7 +2775,7 @@ Object::Set::__compare__(Object *self, PyObject *aOther, int op)
     Py_ssize_t size = -1;
     int eq;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::__compare__");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::__compare__");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -1723,12 +2821,22 @@ Object::Set::__compare__(Object *self, PyObject *aOther, int op)
 PyObject *
 Object::Set::Subtract(Object *self, PyObject *aOther)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::Subtract");
+    PY_ENSURE_TRUE(
+        __check__(aOther), nullptr, PyExc_TypeError,
+        "unsupported operand type(s) for -: 'Set' and '%s'",
+        Py_TYPE(aOther)->tp_name
+    );
+
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::Subtract");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
+    JS::RootedObject aOtherSet(aCx);
     JS::RootedObject aResult(aCx, __copy__(aCx, self));
-    if (!aResult || __sub__(aCx, aOther, &aResult)) {
+    if (
+        !aResult || !__set__(aCx, aOther, &aOtherSet) ||
+        __sub__(aCx, aOtherSet, &aResult)
+    ) {
         return nullptr;
     }
     return WrapObject(aCx, &aResult);
@@ -1739,12 +2847,22 @@ Object::Set::Subtract(Object *self, PyObject *aOther)
 PyObject *
 Object::Set::And(Object *self, PyObject *aOther)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::And");
+    PY_ENSURE_TRUE(
+        __check__(aOther), nullptr, PyExc_TypeError,
+        "unsupported operand type(s) for &: 'Set' and '%s'",
+        Py_TYPE(aOther)->tp_name
+    );
+
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::And");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
-    JS::RootedObject aResult(aCx, __copy__(aCx, self));
-    if (!aResult || __and__(aCx, aOther, &aResult)) {
+    JS::RootedObject aOtherSet(aCx);
+    JS::RootedObject aResult(aCx, self->mJSObject);
+    if (
+        !__set__(aCx, aOther, &aOtherSet) ||
+        __and__(aCx, aOtherSet, &aResult)
+    ) {
         return nullptr;
     }
     return WrapObject(aCx, &aResult);
@@ -1755,12 +2873,22 @@ Object::Set::And(Object *self, PyObject *aOther)
 PyObject *
 Object::Set::Xor(Object *self, PyObject *aOther)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::Xor");
+    PY_ENSURE_TRUE(
+        __check__(aOther), nullptr, PyExc_TypeError,
+        "unsupported operand type(s) for ^: 'Set' and '%s'",
+        Py_TYPE(aOther)->tp_name
+    );
+
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::Xor");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
+    JS::RootedObject aOtherSet(aCx);
     JS::RootedObject aResult(aCx, __copy__(aCx, self));
-    if (!aResult || __xor__(aCx, aOther, &aResult)) {
+    if (
+        !aResult || !__set__(aCx, aOther, &aOtherSet) ||
+        __xor__(aCx, aOtherSet, &aResult)
+    ) {
         return nullptr;
     }
     return WrapObject(aCx, &aResult);
@@ -1771,12 +2899,22 @@ Object::Set::Xor(Object *self, PyObject *aOther)
 PyObject *
 Object::Set::Or(Object *self, PyObject *aOther)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::Or");
+    PY_ENSURE_TRUE(
+        __check__(aOther), nullptr, PyExc_TypeError,
+        "unsupported operand type(s) for |: 'Set' and '%s'",
+        Py_TYPE(aOther)->tp_name
+    );
+
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::Or");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
+    JS::RootedObject aOtherSet(aCx);
     JS::RootedObject aResult(aCx, __copy__(aCx, self));
-    if (!aResult || __or__(aCx, aOther, &aResult)) {
+    if (
+        !aResult || !__set__(aCx, aOther, &aOtherSet) ||
+        __or__(aCx, aOtherSet, &aResult)
+    ) {
         return nullptr;
     }
     return WrapObject(aCx, &aResult);
@@ -1796,7 +2934,7 @@ PyNumberMethods Object::Set::AsNumber = {
 Py_ssize_t
 Object::Set::Length(Object *self)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::Length");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::Length");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -1810,7 +2948,7 @@ Object::Set::Contains(Object *self, PyObject *aValue)
 {
     bool found = false;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::Contains");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::Contains");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -1847,38 +2985,36 @@ Object::Set::RichCompare(Object *self, PyObject *aOther, int op)
 PyObject *
 Object::Set::IsDisjoint(Object *self, PyObject *aOther)
 {
-    PyObject *aIter = nullptr, *aValue = nullptr;
+    size_t i;
     bool found;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::IsDisjoint");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::IsDisjoint");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
-    if (!(aIter = PyObject_GetIter(aOther))) { // +1
+    JS::RootedObject aOtherSet(aCx);
+    if (!__set__(aCx, aOther, &aOtherSet)) {
         return nullptr;
     }
-    JS::RootedValue aJSValue(aCx, JS::UndefinedValue());
-    while ((aValue = PyIter_Next(aIter))) { // +1
+    // walk the smaller set, look into the other one
+    JS::RootedObject aSmall(aCx, self->mJSObject), aLarge(aCx, aOtherSet);
+    if (JS::SetSize(aCx, aOtherSet) < JS::SetSize(aCx, self->mJSObject)) {
+        aSmall.set(aOtherSet);
+        aLarge.set(self->mJSObject);
+    }
+    JS::AutoValueVector aValues(aCx);
+    if (!__values__(aCx, aSmall, aValues)) {
+        return nullptr;
+    }
+    for (i = 0; i < aValues.length(); i++) {
         found = false;
-        aJSValue.set(jspy::Wrap(aCx, aValue));
-        if (
-            aJSValue.isUndefined() ||
-            !JS::SetHas(aCx, self->mJSObject, aJSValue, &found)
-        ) {
-            Py_DECREF(aValue); // -1
-            Py_DECREF(aIter); // -1
+        if (!JS::SetHas(aCx, aLarge, aValues[i], &found)) {
             return nullptr;
         }
-        Py_DECREF(aValue); // -1
         if (found) {
-            Py_DECREF(aIter); // -1
             Py_RETURN_FALSE;
         }
     }
-    Py_DECREF(aIter); // -1
-    if (PyErr_Occurred()) {
-        return nullptr;
-    }
     Py_RETURN_TRUE;
 }
 
@@ -1887,7 +3023,7 @@ Object::Set::IsDisjoint(Object *self, PyObject *aOther)
 PyObject *
 Object::Set::IsSubset(Object *self, PyObject *aOther)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::IsSubset");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::IsSubset");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -1899,7 +3035,7 @@ Object::Set::IsSubset(Object *self, PyObject *aOther)
 PyObject *
 Object::Set::IsSuperset(Object *self, PyObject *aOther)
 {
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::IsSuperset");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::IsSuperset");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -1912,10 +3048,8 @@ PyObject *
 Object::Set::Difference(Object *self, PyObject *args)
 {
     Py_ssize_t size = PyTuple_GET_SIZE(args), i;
-    PyObject *aOther = nullptr;
-    int res = -1;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::Difference");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::Difference");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -1923,11 +3057,12 @@ Object::Set::Difference(Object *self, PyObject *args)
     if (!aResult) {
         return nullptr;
     }
+    JS::RootedObject aOtherSet(aCx);
     for (i = 0; i < size; i++) {
-        aOther = PySet_New(PyTuple_GET_ITEM(args, i)); // +1
-        res = (aOther) ? __sub__(aCx, aOther, &aResult) : -1;
-        Py_XDECREF(aOther); // -1
-        if (res) {
+        if (
+            !__set__(aCx, PyTuple_GET_ITEM(args, i), &aOtherSet) ||
+            __sub__(aCx, aOtherSet, &aResult)
+        ) {
             return nullptr;
         }
     }
@@ -1940,10 +3075,8 @@ PyObject *
 Object::Set::Intersection(Object *self, PyObject *args)
 {
     Py_ssize_t size = PyTuple_GET_SIZE(args), i;
-    PyObject *aOther = nullptr;
-    int res = -1;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::Intersection");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::Intersection");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -1951,11 +3084,12 @@ Object::Set::Intersection(Object *self, PyObject *args)
     if (!aResult) {
         return nullptr;
     }
+    JS::RootedObject aOtherSet(aCx);
     for (i = 0; i < size; i++) {
-        aOther = PySet_New(PyTuple_GET_ITEM(args, i)); // +1
-        res = (aOther) ? __and__(aCx, aOther, &aResult) : -1;
-        Py_XDECREF(aOther); // -1
-        if (res) {
+        if (
+            !__set__(aCx, PyTuple_GET_ITEM(args, i), &aOtherSet) ||
+            __and__(aCx, aOtherSet, &aResult)
+        ) {
             return nullptr;
         }
     }
@@ -1968,10 +3102,8 @@ PyObject *
 Object::Set::SymmetricDifference(Object *self, PyObject *args)
 {
     Py_ssize_t size = PyTuple_GET_SIZE(args), i;
-    PyObject *aOther = nullptr;
-    int res = -1;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::SymmetricDifference");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::SymmetricDifference");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -1979,11 +3111,12 @@ Object::Set::SymmetricDifference(Object *self, PyObject *args)
     if (!aResult) {
         return nullptr;
     }
+    JS::RootedObject aOtherSet(aCx);
     for (i = 0; i < size; i++) {
-        aOther = PySet_New(PyTuple_GET_ITEM(args, i)); // +1
-        res = (aOther) ? __xor__(aCx, aOther, &aResult) : -1;
-        Py_XDECREF(aOther); // -1
-        if (res) {
+        if (
+            !__set__(aCx, PyTuple_GET_ITEM(args, i), &aOtherSet) ||
+            __xor__(aCx, aOtherSet, &aResult)
+        ) {
             return nullptr;
         }
     }
@@ -1996,10 +3129,8 @@ PyObject *
 Object::Set::Union(Object *self, PyObject *args)
 {
     Py_ssize_t size = PyTuple_GET_SIZE(args), i;
-    PyObject *aOther = nullptr;
-    int res = -1;
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Set::Union");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::Union");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -2007,11 +3138,12 @@ Object::Set::Union(Object *self, PyObject *args)
     if (!aResult) {
         return nullptr;
     }
+    JS::RootedObject aOtherSet(aCx);
     for (i = 0; i < size; i++) {
-        aOther = PySet_New(PyTuple_GET_ITEM(args, i)); // +1
-        res = (aOther) ? __or__(aCx, aOther, &aResult) : -1;
-        Py_XDECREF(aOther); // -1
-        if (res) {
+        if (
+            !__set__(aCx, PyTuple_GET_ITEM(args, i), &aOtherSet) ||
+            __or__(aCx, aOtherSet, &aResult)
+        ) {
             return nullptr;
         }
     }
@@ -2019,6 +3151,22 @@ Object::Set::Union(Object *self, PyObject *args)
 }
 
 
+// Object::Set::Type.tp_iter
+PyObject *
+Object::Set::Iter(Object *self)
+{
+    AutoScript aes(self->mJSObject, "pyjs::Object::Set::Iter");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    JS::RootedValue aIterator(aCx);
+    if (!__iter__(aCx, self, &aIterator)) {
+        return nullptr;
+    }
+    return Entries::New(aCx, aIterator, Entries::Values);
+}
+
+
 // Object::Set::Type.tp_methods
 PyMethodDef Object::Set::Methods[] = {
     {"isdisjoint", (PyCFunction)Object::Set::IsDisjoint, METH_O, nullptr},
@@ -2041,7 +3189,7 @@ PyTypeObject Object::Set::Type = {
     .tp_as_sequence = &Object::Set::AsSequence,
     .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_FINALIZE),
     .tp_richcompare = (richcmpfunc)Object::Set::RichCompare,
-    .tp_iter = (getiterfunc)Object::Iter<Object::Set>,
+    .tp_iter = (getiterfunc)Object::Set::Iter,
     .tp_methods = Object::Set::Methods,
 };
 
@@ -2095,7 +3243,7 @@ Object::Callable::Call(Object *self, PyObject *aArgs, PyObject *aKwargs)
         !aKwargs, nullptr, PyExc_TypeError, "JavaScript does not support kwargs"
     );
 
-    dom::AutoEntryScript aes(self->mJSObject, "pyjs::Object::Callable::Call");
+    AutoScript aes(self->mJSObject, "pyjs::Object::Callable::Call");
     JSContext *aCx = aes.cx();
     AutoReporter ar(aCx);
 
@@ -2124,5 +3272,299 @@ PyTypeObject Object::Callable::Type = {
 };
 
 
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::pyjs::Object::Promise
+   -------------------------------------------------------------------------- */
+
+// Object::Promise::AsAsync.am_await, settles through the microtask queue
+PyObject *
+Object::Promise::Await(Object *self)
+{
+    AutoScript aes(self->mJSObject, "pyjs::Object::Promise::Await");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    JS::RootedValue aPromise(aCx, JS::ObjectValue(*self->mJSObject));
+    return Awaitable::New(aCx, aPromise, Awaitable::Value);
+}
+
+
+// Object::Promise::AsAsync
+PyAsyncMethods Object::Promise::AsAsync = {
+    .am_await = (unaryfunc)Object::Promise::Await,
+};
+
+
+// Object::Promise::Type
+PyTypeObject Object::Promise::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul::wrappers::pyjs::Object::Promise",
+    .tp_basicsize = sizeof(Object),
+    .tp_as_async = &Object::Promise::AsAsync,
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_FINALIZE),
+};
+
+
+/* --------------------------------------------------------------------------
+   pyxul::wrappers::pyjs::Object::Signature
+   -------------------------------------------------------------------------- */
+
+char
+Object::Signature::__code__(PyObject *aType, bool result)
+{
+    if (aType == (PyObject *)&PyLong_Type) {
+        return 'i';
+    }
+    if (aType == (PyObject *)&PyFloat_Type) {
+        return 'd';
+    }
+    if (aType == (PyObject *)&PyBool_Type) {
+        return 'b';
+    }
+    if (aType == (PyObject *)&PyUnicode_Type) {
+        return 's';
+    }
+    if (aType == (PyObject *)&PyBaseObject_Type) {
+        return 'o';
+    }
+    if (result && aType == Py_None) {
+        return 'v';
+    }
+    PyErr_Format(
+        PyExc_TypeError,
+        "expected int, float, bool, str, object%s, got %R",
+        result ? " or None" : "", aType
+    );
+    return 0;
+}
+
+
+// returns JS::UndefinedValue() on error
+JS::Value
+Object::Signature::__arg__(JSContext *aCx, char code, PyObject *aValue)
+{
+    double number = 0.0;
+    long value = 0;
+    int overflow = 0, truth = -1;
+
+    switch (code) {
+        case 'i':
+            value = PyLong_AsLongAndOverflow(aValue, &overflow);
+            if (overflow) {
+                number = PyLong_AsDouble(aValue);
+                break;
+            }
+            if (value == -1 && PyErr_Occurred()) {
+                return JS::UndefinedValue();
+            }
+            return JS::NumberValue(value);
+        case 'd':
+            number = PyFloat_AsDouble(aValue);
+            break;
+        case 'b':
+            if ((truth = PyObject_IsTrue(aValue)) < 0) {
+                return JS::UndefinedValue();
+            }
+            return JS::BooleanValue(truth);
+        case 's':
+            PY_ENSURE_TRUE(
+                PyUnicode_Check(aValue), JS::UndefinedValue(),
+                PyExc_TypeError, "expected str, got %R", Py_TYPE(aValue)
+            );
+            return jspy::WrapUnicode(aCx, aValue);
+        default:
+            return jspy::Wrap(aCx, aValue);
+    }
+    if (number == -1.0 && PyErr_Occurred()) {
+        return JS::UndefinedValue();
+    }
+    return JS::DoubleValue(JS::CanonicalizeNaN(number));
+}
+
+
+PyObject *
+Object::Signature::__result__(
+    JSContext *aCx, char code, JS::HandleValue aValue
+)
+{
+    double number = 0.0;
+
+    switch (code) {
+        case 'v':
+            Py_RETURN_NONE;
+        case 'i':
+            if (aValue.isInt32()) {
+                return PyLong_FromLong(aValue.toInt32());
+            }
+            if (!JS::ToNumber(aCx, aValue, &number)) {
+                return nullptr;
+            }
+            return PyLong_FromDouble(number);
+        case 'd':
+            if (!JS::ToNumber(aCx, aValue, &number)) {
+                return nullptr;
+            }
+            return PyFloat_FromDouble(number);
+        case 'b':
+            return PyBool_FromLong(JS::ToBoolean(aValue));
+        case 's':
+            {
+                JS::RootedString aJSString(aCx, JS::ToString(aCx, aValue));
+                return aJSString ? WrapString(aCx, aJSString) : nullptr;
+            }
+        default:
+            if (aValue.isUndefined()) {
+                Py_RETURN_NONE;
+            }
+            return Wrap(aCx, aValue);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Object::Signature::Type.tp_repr
+PyObject *
+Object::Signature::Repr(Signature *self)
+{
+    PyObject *result = nullptr, *aRepr = nullptr;
+
+    AutoScript aes(self->mJSObject, "pyjs::Object::Signature::Repr");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    if ((aRepr = __str__(aCx, self))) {
+        result = PyUnicode_FromFormat(
+            "<%s object at %p; codes: %S; wrapping: %U>",
+            Py_TYPE(self)->tp_name, self, self->mCodes, aRepr
+        );
+        Py_DECREF(aRepr);
+    }
+    return result;
+}
+
+
+// Object::Signature::Type.tp_call
+PyObject *
+Object::Signature::Call(Signature *self, PyObject *aArgs, PyObject *aKwargs)
+{
+    const char *codes = PyBytes_AS_STRING(self->mCodes);
+    Py_ssize_t size = PyBytes_GET_SIZE(self->mCodes) - 1, i;
+    JS::Value arg = JS::UndefinedValue();
+
+    PY_ENSURE_TRUE(
+        !aKwargs, nullptr, PyExc_TypeError, "JavaScript does not support kwargs"
+    );
+    PY_ENSURE_TRUE(
+        (PyTuple_GET_SIZE(aArgs) == size), nullptr,
+        PyExc_TypeError, "expected %zd arguments, got %zd",
+        size, PyTuple_GET_SIZE(aArgs)
+    );
+
+    AutoScript aes(self->mJSObject, "pyjs::Object::Signature::Call");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    JS::RootedValue aFunction(aCx, JS::ObjectValue(*self->mJSObject));
+    JS::AutoValueVector aJSArgs(aCx);
+    if (size && !aJSArgs.reserve(size)) {
+        return PyErr_NoMemory();
+    }
+    for (i = 0; i < size; i++) {
+        arg = __arg__(aCx, codes[i + 1], PyTuple_GET_ITEM(aArgs, i)); // borrowed
+        if (arg.isUndefined()) {
+            if (!PyErr_Occurred()) {
+                PyErr_Format(PyExc_TypeError, "failed to convert argument %zd", i);
+            }
+            return nullptr;
+        }
+        aJSArgs.infallibleAppend(arg);
+    }
+    JS::RootedValue aResult(aCx, JS::UndefinedValue());
+    if (!JS::Call(aCx, self->mThis, aFunction, aJSArgs, &aResult)) {
+        return nullptr;
+    }
+    return __result__(aCx, codes[0], aResult);
+}
+
+
+// Object::Signature::Type.tp_finalize
+void
+Object::Signature::Finalize(Signature *self)
+{
+    Py_CLEAR(self->mCodes);
+    Object::Finalize(self);
+}
+
+
+// Object::Signature::Type
+PyTypeObject Object::Signature::Type = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    .tp_name = "pyxul::wrappers::pyjs::Object::Signature",
+    .tp_basicsize = sizeof(Object::Signature),
+    .tp_repr = (reprfunc)Object::Signature::Repr,
+    .tp_call = (ternaryfunc)Object::Signature::Call,
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_FINALIZE),
+    .tp_finalize = (destructor)Object::Signature::Finalize,
+};
+
+
+/* public ------------------------------------------------------------------- */
+
+PyObject *
+Object::Signature::New(
+    PyObject *aCallable, PyObject *aArgTypes, PyObject *aResType
+)
+{
+    Object *aFunction = (Object *)aCallable;
+    PyObject *aTypes = nullptr, *aCodes = nullptr;
+    Signature *self = nullptr;
+    Py_ssize_t size = 0, i;
+    char *codes = nullptr;
+
+    PY_ENSURE_TRUE(
+        PyObject_TypeCheck(aCallable, &Object::Callable::Type), nullptr,
+        PyExc_TypeError, "expected a JavaScript function, got %R",
+        Py_TYPE(aCallable)
+    );
+    if (!(aTypes = PySequence_Fast(aArgTypes, "expected a sequence of types"))) { // +1
+        return nullptr;
+    }
+    size = PySequence_Fast_GET_SIZE(aTypes);
+    if ((aCodes = PyBytes_FromStringAndSize(nullptr, size + 1))) { // +1
+        codes = PyBytes_AS_STRING(aCodes);
+        if ((codes[0] = __code__(aResType, true))) {
+            for (i = 0; i < size; i++) {
+                codes[i + 1] = __code__(
+                    PySequence_Fast_GET_ITEM(aTypes, i), false // borrowed
+                );
+                if (!codes[i + 1]) {
+                    break;
+                }
+            }
+            if (i == size) {
+                AutoScript aes(
+                    aFunction->mJSObject, "pyjs::Object::Signature::New"
+                );
+                JSContext *aCx = aes.cx();
+                AutoReporter ar(aCx);
+
+                if (
+                    (self = (Signature *)Alloc<Object::Signature>(
+                        aCx, aFunction->mJSObject, aFunction->mThis
+                    ))
+                ) {
+                    Py_INCREF(aCodes);
+                    self->mCodes = aCodes;
+                }
+            }
+        }
+        Py_DECREF(aCodes); // -1
+    }
+    Py_DECREF(aTypes); // -1
+    return self;
+}
+
+
 } // namespace pyxul::wrappers::pyjs
 
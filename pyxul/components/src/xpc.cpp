@@ -19,6 +19,7 @@
 #include "xpc.h"
 
 #include "errors.h"
+#include "events.h"
 #include "modules.h"
 #include "python.h"
 #include "runtime.h"
@@ -46,15 +47,22 @@ namespace pyxul {
 
 /* AutoReporter ------------------------------------------------------------- */
 
+unsigned int AutoReporter::sDepth = 0;
+JS::WarningReporter AutoReporter::sWarningReporter = nullptr;
+
+
 AutoReporter::AutoReporter(JSContext *aCx): mCx(aCx)
 {
-    mWarningReporter = JS::SetWarningReporter(mCx, ReportWarning);
+    if (!sDepth++) {
+        sWarningReporter = JS::SetWarningReporter(mCx, ReportWarning);
+    }
 }
 
 
 AutoReporter::~AutoReporter()
 {
-    if (JS_IsExceptionPending(mCx)) {
+    // nothing else to do on the fast path
+    if (MOZ_UNLIKELY(JS_IsExceptionPending(mCx))) {
         JS::RootedValue aException(mCx, JS::UndefinedValue());
         if (JS_GetPendingException(mCx, &aException) && aException.isObject()) {
             JS_ClearPendingException(mCx);
@@ -64,7 +72,10 @@ AutoReporter::~AutoReporter()
             }
         }
     }
-    JS::SetWarningReporter(mCx, mWarningReporter);
+    if (!--sDepth) {
+        JS::SetWarningReporter(mCx, sWarningReporter);
+        sWarningReporter = nullptr;
+    }
 }
 
 
@@ -115,6 +126,51 @@ AutoReporter::ReportWarning(JSContext *aCx, JSErrorReport *aReport)
 }
 
 
+/* AutoScript --------------------------------------------------------------- */
+
+AutoScript::AutoScript(JSObject *aObject, const char *aReason): mCx(nullptr)
+{
+    if (dom::GetEntryGlobal()) {
+        mCx = dom::danger::GetJSContext();
+        mAutoCompartment.emplace(mCx, aObject);
+    }
+    else {
+        mEntryScript.emplace(aObject, aReason);
+        mCx = mEntryScript->cx();
+    }
+}
+
+
+AutoScript::~AutoScript()
+{
+    PyObject *aReason = nullptr;
+
+    // AutoReporter only translates error objects, don't leak anything else
+    // to the outer entry (a real entry would have reported it), raise it
+    // wrapped in a JSError instead (i.e. throw 42)
+    if (mAutoCompartment && JS_IsExceptionPending(mCx)) {
+        JS::RootedValue aJSValue(mCx);
+        if (!JS_GetPendingException(mCx, &aJSValue)) {
+            aJSValue.setUndefined();
+        }
+        JS_ClearPendingException(mCx);
+        if (!PyErr_Occurred()) {
+            if (
+                !aJSValue.isUndefined() &&
+                (aReason = pyjs::Wrap(mCx, aJSValue)) // +1
+            ) {
+                PyErr_SetObject(errors::JSError, aReason);
+                Py_DECREF(aReason); // -1
+            }
+            else {
+                PyErr_Clear();
+                PyErr_SetString(errors::JSError, "uncaught exception");
+            }
+        }
+    }
+}
+
+
 namespace xpc {
 
 
@@ -203,6 +259,207 @@ ImportModule(const char *aUri, PyObject *aTarget)
 }
 
 
+/* compiled functions ------------------------------------------------------- */
+
+namespace { // anonymous
+
+
+// key of the per global cache of compiled functions
+static JS::PersistentRootedSymbol sFunctionsKey;
+
+
+// the cache lives on the global itself, so it goes away with it. It has no
+// prototype and its entries can't be replaced
+static bool
+__functions__(
+    JSContext *aCx, JS::HandleObject aGlobal, JS::MutableHandleObject aResult
+)
+{
+    if (!sFunctionsKey.initialized()) {
+        JS::RootedString aDescription(
+            aCx, JS_NewStringCopyZ(aCx, "pyxul.js_function")
+        );
+        if (!aDescription) {
+            return false;
+        }
+        sFunctionsKey.init(aCx, JS::NewSymbol(aCx, aDescription));
+        if (!sFunctionsKey) {
+            sFunctionsKey.reset();
+            return false;
+        }
+    }
+    JS::RootedId aId(aCx, SYMBOL_TO_JSID(sFunctionsKey));
+    JS::RootedValue aCache(aCx);
+    if (!JS_GetPropertyById(aCx, aGlobal, aId, &aCache)) {
+        return false;
+    }
+    if (aCache.isObject()) {
+        aResult.set(&aCache.toObject());
+        return true;
+    }
+    aResult.set(JS_NewObjectWithGivenProto(aCx, nullptr, nullptr));
+    return (
+        aResult &&
+        JS_DefinePropertyById(
+            aCx, aGlobal, aId, aResult, JSPROP_READONLY | JSPROP_PERMANENT
+        )
+    );
+}
+
+
+static bool
+__compile__(
+    JSContext *aCx, PyObject *aParams, PyObject *aBody,
+    JS::MutableHandleObject aResult
+)
+{
+    PyObject *aBytes = nullptr;
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(aParams), i;
+    const char *name = nullptr;
+    bool result = false;
+
+    mozilla::UniquePtr<const char *[]> names(new const char *[size + 1]);
+    for (i = 0; i < size; i++) {
+        if (!(name = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(aParams, i)))) {
+            return false;
+        }
+        names[i] = name;
+    }
+    if ((aBytes = PyUnicode_AsUTF16String(aBody))) { // +1
+        JS::CompileOptions options(aCx);
+        options.setFileAndLine("pyxul.js_function", 1);
+        JS::AutoObjectVector aEnvChain(aCx);
+        JS::RootedFunction aFunction(aCx);
+        if (
+            JS::CompileFunction(
+                aCx, aEnvChain, options, nullptr, size, names.get(),
+                (const char16_t *)(PyBytes_AS_STRING(aBytes) + 2),
+                ((PyBytes_GET_SIZE(aBytes) / 2) - 1), &aFunction
+            )
+        ) {
+            aResult.set(JS_GetFunctionObject(aFunction));
+            result = true;
+        }
+        Py_DECREF(aBytes); // -1
+    }
+    return result;
+}
+
+
+static JSObject *
+__global__(JSContext *aCx)
+{
+    nsIGlobalObject *aEntryGlobal = nullptr;
+
+    if ((aEntryGlobal = dom::GetEntryGlobal())) {
+        return Unwrap(aEntryGlobal->GetGlobalJSObject());
+    }
+    return pyRuntime::GetJSGlobal(aCx);
+}
+
+
+static PyObject *
+__function__(
+    JS::HandleObject aGlobal, PyObject *aParams, PyObject *aBody,
+    PyObject *aSource
+)
+{
+    AutoScript aes(aGlobal, "pyxul::xpc::CompileFunction");
+    JSContext *aCx = aes.cx();
+    AutoReporter ar(aCx);
+
+    JS::RootedObject aCache(aCx), aFunction(aCx);
+    JS::RootedValue aKey(aCx, jspy::Wrap(aCx, aSource));
+    JS::RootedId aId(aCx);
+    JS::RootedValue aValue(aCx);
+    if (
+        aKey.isUndefined() || !JS_ValueToId(aCx, aKey, &aId) ||
+        !__functions__(aCx, aGlobal, &aCache) ||
+        !JS_GetPropertyById(aCx, aCache, aId, &aValue)
+    ) {
+        return nullptr;
+    }
+    if (aValue.isObject()) {
+        aFunction = &aValue.toObject();
+    }
+    else if (
+        !__compile__(aCx, aParams, aBody, &aFunction) ||
+        !JS_DefinePropertyById(
+            aCx, aCache, aId, aFunction, JSPROP_READONLY | JSPROP_PERMANENT
+        )
+    ) {
+        return nullptr;
+    }
+    return pyjs::WrapObject(aCx, &aFunction);
+}
+
+
+} // namespace anonymous
+
+
+// compile once per (global, source) in the entry global (the window running
+// the Python code) or our own global
+PyObject *
+CompileFunction(PyObject *aParams, PyObject *aBody)
+{
+    _Py_static_string(PyId_comma, ", ");
+    PyObject *aSeq = nullptr, *aNames = nullptr, *aSource = nullptr;
+    PyObject *aName = nullptr, *result = nullptr;
+    Py_ssize_t size = 0, i;
+
+    PY_ENSURE_TRUE(
+        PyUnicode_Check(aBody), nullptr,
+        PyExc_TypeError, "body must be a str, not %R", Py_TYPE(aBody)
+    );
+    // a str (or bytes) is a sequence, of one letter names
+    PY_ENSURE_TRUE(
+        !PyUnicode_Check(aParams) && !PyBytes_Check(aParams) &&
+        !PyByteArray_Check(aParams), nullptr,
+        PyExc_TypeError, "params must be a sequence of str, not %R",
+        Py_TYPE(aParams)
+    );
+    if (!(aSeq = PySequence_Fast(aParams, "params must be a sequence"))) { // +1
+        return nullptr;
+    }
+    // the source is the cache key, names must not be able to forge it
+    size = PySequence_Fast_GET_SIZE(aSeq);
+    for (i = 0; i < size; i++) {
+        aName = PySequence_Fast_GET_ITEM(aSeq, i); // borrowed
+        if (!PyUnicode_Check(aName)) {
+            PyErr_Format(
+                PyExc_TypeError, "params must be str, not %R", Py_TYPE(aName)
+            );
+        }
+        else if (!PyUnicode_IsIdentifier(aName)) {
+            PyErr_Format(
+                PyExc_ValueError, "params must be identifiers, not %R", aName
+            );
+        }
+        if (PyErr_Occurred()) {
+            Py_DECREF(aSeq); // -1
+            return nullptr;
+        }
+    }
+    if ((aNames = PyUnicode_Join(_PyUnicode_FromId(&PyId_comma), aSeq))) { // +1
+        aSource = PyUnicode_FromFormat("(%U) {\n%U\n}", aNames, aBody); // +1
+        Py_DECREF(aNames); // -1
+    }
+    if (aSource) {
+        AutoJSContext aCx;
+        JS::RootedObject aGlobal(aCx, __global__(aCx));
+        if (aGlobal) {
+            result = __function__(aGlobal, aSeq, aBody, aSource);
+        }
+        else {
+            PyErr_SetString(errors::XPCOMError, "Failed to get global object");
+        }
+        Py_DECREF(aSource); // -1
+    }
+    Py_DECREF(aSeq); // -1
+    return result;
+}
+
+
 /* errors/warnings handling ------------------------------------------------- */
 
 bool
@@ -715,6 +972,7 @@ __initialize__()
 
     if (
         errors::Initialize() &&
+        events::Initialize() &&
         __getSpecialDir__(XRE_APP_DISTRIBUTION_DIR, distDirs, aDistPath) &&
         __getSpecialDir__(NS_OS_CURRENT_PROCESS_DIR, siteDirs, aSitePath) &&
         !_Py_Setup(aDistPath.get(), aSitePath.get()) &&
@@ -732,8 +990,11 @@ __finalize__()
 {
     AutoGILState ags; // XXX: important
 
+    events::Finalize();
     modules::Finalize();
+    sFunctionsKey.reset();
     jspy::Finalize();
+    pyjs::Finalize();
     errors::Finalize();
 
     __collect__();
@@ -28,6 +28,7 @@
 #include "nsIURI.h"
 
 #include "mozilla/FileLocation.h"
+#include "mozilla/Maybe.h"
 
 
 namespace pyxul {
@@ -40,11 +41,34 @@ namespace pyxul {
 
         private:
             JSContext *mCx;
-            JS::WarningReporter mWarningReporter;
 
             bool ReportError(JS::HandleObject aError);
 
             static void ReportWarning(JSContext *aCx, JSErrorReport *aReport);
+
+            // the warning reporter is only swapped by the outermost instance
+            static unsigned int sDepth;
+            static JS::WarningReporter sWarningReporter;
+    };
+
+
+    // use in place of dom::AutoEntryScript for short operations on behalf of
+    // Python: when a script entry is already active (we're called from JS or
+    // from code run by xpc::Execute) only the compartment is entered, a real
+    // entry (and its microtask checkpoint) is only made at the outermost level
+    class MOZ_STACK_CLASS AutoScript final {
+        public:
+            AutoScript(JSObject *aObject, const char *aReason);
+            ~AutoScript();
+
+            JSContext *cx() const {
+                return mCx;
+            }
+
+        private:
+            JSContext *mCx;
+            mozilla::Maybe<dom::AutoEntryScript> mEntryScript;
+            mozilla::Maybe<JSAutoCompartment> mAutoCompartment;
     };
 
 
@@ -58,6 +82,7 @@ namespace pyxul {
         PyObject *GetJSGlobal();
 
         bool ImportModule(const char *aUri, PyObject *aTarget);
+        PyObject *CompileFunction(PyObject *aParams, PyObject *aBody);
 
         bool ReportError();
         bool SetException(
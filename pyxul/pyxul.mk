@@ -19,3 +19,5 @@ pyxul_id = "pyxul@python.org"
 pyxul_version = "0.9.0"
 python_minversion = "3.9"
 
+# define real accessor properties on jspy wrappers (see wrappers/internals.h)
+pyxul_jspy_accessors = False